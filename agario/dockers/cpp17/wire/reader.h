@@ -0,0 +1,180 @@
+#ifndef WIRE_READER_H
+#define WIRE_READER_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+
+// Чтение двоичного протокола механики (local_runner/core/wire_format.h).
+// Протокол включается в первом сообщении клиента: "protocol": "binary" рядом
+// с solution_id. Дальше механика шлёт кадры: u32 длина, u8 вид, данные; все
+// числа little-endian.
+//
+//   wire::Reader reader(std::cin);
+//   wire::Config config;
+//   reader.read_config(config);
+//   wire::State state;
+//   while (reader.read_state(state)) {
+//       ...
+//   }
+
+namespace wire {
+
+enum FrameKind {
+    CONFIG = 1, STATE = 2, COMMAND = 3, ERROR = 4
+};
+
+constexpr size_t LENGTH_SIZE = 4;
+constexpr size_t FRAGMENT_SIZE = 64;
+constexpr size_t OBJECT_SIZE = 48;
+
+struct Config {
+    int game_width, game_height, game_ticks, max_frags_cnt, ticks_til_fusion;
+    double food_mass, virus_radius, virus_split_mass, viscosity, inertion_factor, speed_factor;
+};
+
+// свой фрагмент
+struct Fragment {
+    int id, fragment_id;
+    double x, y, r, m, sx, sy;
+    int ttf;                    // 0 - таймера слияния нет
+
+    // "1" или "1.2", как Id в JSON
+    std::string id_str() const {
+        return fragment_id > 0? std::to_string(id) + "." + std::to_string(fragment_id) : std::to_string(id);
+    }
+};
+
+// видимый объект; поля, которых у него нет, - нули
+struct Object {
+    char type;                  // 'F', 'E', 'V', 'P'
+    int id;
+    int extra;                  // номер фрагмента у игрока, игрок выброса
+    double x, y, m, r;
+};
+
+struct State {
+    int tick;
+    std::vector<Fragment> mine;
+    std::vector<Object> objects;
+};
+
+class Reader {
+private:
+    std::istream &in;
+    std::string frame;
+    const unsigned char *p;
+
+    uint32_t get_u32() {
+        uint32_t value = p[0] | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+        p += 4;
+        return value;
+    }
+
+    int get_int() {
+        return int32_t(get_u32());
+    }
+
+    unsigned get_u16() {
+        unsigned value = p[0] | unsigned(p[1]) << 8;
+        p += 2;
+        return value;
+    }
+
+    double get_double() {
+        uint64_t bits = 0;
+        for (int I = 0; I < 8; I++) {
+            bits |= uint64_t(p[I]) << (8 * I);
+        }
+        p += 8;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // читает кадр вида kind; false - поток кончился или пришло не то
+    bool read_frame(FrameKind kind, size_t min_size) {
+        char length[LENGTH_SIZE];
+        if (! in.read(length, sizeof(length))) {
+            return false;
+        }
+        p = (const unsigned char*)length;
+        uint32_t size = get_u32();
+        frame.resize(size);
+        if (size == 0 || ! in.read(&frame[0], size)) {
+            return false;
+        }
+        p = (const unsigned char*)frame.data();
+        return *p++ == kind && size >= 1 + min_size;
+    }
+
+public:
+    explicit Reader(std::istream &_in) :
+        in(_in),
+        p(nullptr)
+    {}
+
+    bool read_config(Config &config) {
+        if (! read_frame(CONFIG, 5 * 4 + 6 * 8)) {
+            return false;
+        }
+        config.game_width = get_int();
+        config.game_height = get_int();
+        config.game_ticks = get_int();
+        config.max_frags_cnt = get_int();
+        config.ticks_til_fusion = get_int();
+        config.food_mass = get_double();
+        config.virus_radius = get_double();
+        config.virus_split_mass = get_double();
+        config.viscosity = get_double();
+        config.inertion_factor = get_double();
+        config.speed_factor = get_double();
+        return true;
+    }
+
+    // память векторов state переиспользуется от тика к тику
+    bool read_state(State &state) {
+        if (! read_frame(STATE, 8)) {
+            return false;
+        }
+        state.tick = get_int();
+        size_t mine_cnt = get_u16();
+        size_t objects_cnt = get_u16();
+        if (frame.size() < 1 + 8 + mine_cnt * FRAGMENT_SIZE + objects_cnt * OBJECT_SIZE) {
+            return false;
+        }
+        state.mine.resize(mine_cnt);
+        for (Fragment &fragment : state.mine) {
+            fragment.id = get_int();
+            fragment.fragment_id = get_int();
+            fragment.x = get_double();
+            fragment.y = get_double();
+            fragment.r = get_double();
+            fragment.m = get_double();
+            fragment.sx = get_double();
+            fragment.sy = get_double();
+            fragment.ttf = get_int();
+            p += 4;
+        }
+        state.objects.resize(objects_cnt);
+        for (Object &object : state.objects) {
+            object.type = char(*p);
+            p += 4;
+            object.id = get_int();
+            object.extra = get_int();
+            p += 4;
+            object.x = get_double();
+            object.y = get_double();
+            object.m = get_double();
+            object.r = get_double();
+        }
+        return true;
+    }
+};
+
+} // namespace wire
+
+#endif // WIRE_READER_H
@@ -0,0 +1,90 @@
+#ifndef WIRE_WRITER_H
+#define WIRE_WRITER_H
+
+#include "reader.h"
+
+#include <ostream>
+#include <string>
+
+
+// Ответы механике в двоичном протоколе (см. reader.h):
+//
+//   wire::Writer writer(std::cout);
+//   wire::Command command;
+//   command.x = 100; command.y = 200;
+//   writer.write(command);
+
+namespace wire {
+
+struct Command {
+    double x = 0, y = 0;
+    bool split = false, eject = false;
+    std::string debug;
+    std::string sprite_id, sprite;      // отладочная надпись у фрагмента sprite_id
+};
+
+class Writer {
+private:
+    std::ostream &out;
+    std::string frame;
+
+    void put_u8(unsigned value) {
+        frame += char(value & 0xFF);
+    }
+
+    void put_u16(unsigned value) {
+        frame += char(value & 0xFF);
+        frame += char((value >> 8) & 0xFF);
+    }
+
+    void put_double(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int I = 0; I < 8; I++) {
+            frame += char((bits >> (8 * I)) & 0xFF);
+        }
+    }
+
+    void put_string(const std::string &value) {
+        size_t size = value.size() < 0xFFFF? value.size() : 0xFFFF;
+        put_u16(size);
+        frame.append(value, 0, size);
+    }
+
+    void send() {
+        uint32_t size = uint32_t(frame.size() - LENGTH_SIZE);
+        for (int I = 0; I < 4; I++) {
+            frame[I] = char((size >> (8 * I)) & 0xFF);
+        }
+        out.write(frame.data(), frame.size());
+        out.flush();
+    }
+
+public:
+    explicit Writer(std::ostream &_out) :
+        out(_out)
+    {}
+
+    void write(const Command &command) {
+        frame.assign(LENGTH_SIZE, '\0');
+        put_u8(COMMAND);
+        put_double(command.x);
+        put_double(command.y);
+        put_u8((command.split? 1 : 0) | (command.eject? 2 : 0));
+        put_string(command.debug);
+        put_string(command.sprite_id);
+        put_string(command.sprite);
+        send();
+    }
+
+    void write_error(const std::string &message) {
+        frame.assign(LENGTH_SIZE, '\0');
+        put_u8(ERROR);
+        put_string(message);
+        send();
+    }
+};
+
+} // namespace wire
+
+#endif // WIRE_WRITER_H
@@ -0,0 +1,94 @@
+#ifndef ADAPTERS_JSON_H
+#define ADAPTERS_JSON_H
+
+#include "../core/entities/food.h"
+#include "../core/entities/virus.h"
+#include "../core/entities/player.h"
+#include "../core/entities/ejection.h"
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+
+inline QJsonObject to_json(const Food *food) {
+    QJsonObject objData;
+    objData.insert("X", QJsonValue(food->getX()));
+    objData.insert("Y", QJsonValue(food->getY()));
+    objData.insert("T", QJsonValue("F"));
+    return objData;
+}
+
+inline QJsonObject to_json(const Ejection *eject) {
+    QJsonObject objData;
+    objData.insert("X", QJsonValue(eject->getX()));
+    objData.insert("Y", QJsonValue(eject->getY()));
+    objData.insert("T", QJsonValue("E"));
+    objData.insert("Id", QJsonValue(QString::number(eject->getId())));
+    objData.insert("pId", QJsonValue(eject->get_player()));
+    return objData;
+}
+
+inline QJsonObject to_json(const Virus *virus) {
+    QJsonObject objData;
+    objData.insert("X", QJsonValue(virus->getX()));
+    objData.insert("Y", QJsonValue(virus->getY()));
+    objData.insert("M", QJsonValue(virus->getM()));
+    objData.insert("T", QJsonValue("V"));
+    objData.insert("Id", QJsonValue(QString::number(virus->getId())));
+    return objData;
+}
+
+inline QJsonObject to_json(const Player *player, bool mine=false) {
+    QJsonObject objData;
+    objData.insert("Id", QJsonValue(QString::fromStdString(player->id_to_str())));
+    objData.insert("X", QJsonValue(player->getX()));
+    objData.insert("Y", QJsonValue(player->getY()));
+    objData.insert("M", QJsonValue(player->getM()));
+    objData.insert("R", QJsonValue(player->getR()));
+    if (mine) {
+        objData.insert("SX", QJsonValue(player->get_speed() * std::cos(player->getA())));
+        objData.insert("SY", QJsonValue(player->get_speed() * std::sin(player->getA())));
+        if (player->fuse_timer > 0) {
+            objData.insert("TTF", QJsonValue(player->fuse_timer));
+        }
+    }
+    else {
+        objData.insert("T", QJsonValue("P"));
+    }
+    return objData;
+}
+
+// видимые объекты приходят из механики как Circle*
+inline QJsonObject to_json(const Circle *circle, bool mine=false) {
+    if (circle->is_player()) {
+        return to_json(static_cast<const Player*>(circle), mine);
+    }
+    if (circle->is_virus()) {
+        return to_json(static_cast<const Virus*>(circle));
+    }
+    if (circle->is_ejection()) {
+        return to_json(static_cast<const Ejection*>(circle));
+    }
+    return to_json(static_cast<const Food*>(circle));
+}
+
+inline QJsonObject to_json(const GameConfig &config) {
+    return {
+        {"GAME_WIDTH", config.GAME_WIDTH},
+        {"GAME_HEIGHT", config.GAME_HEIGHT},
+        {"GAME_TICKS", config.GAME_TICKS},
+
+        {"FOOD_MASS", config.FOOD_MASS},
+        {"MAX_FRAGS_CNT", config.MAX_FRAGS_CNT},
+        {"TICKS_TIL_FUSION", config.TICKS_TIL_FUSION},
+        {"VIRUS_RADIUS", config.VIRUS_RADIUS},
+        {"VIRUS_SPLIT_MASS", config.VIRUS_SPLIT_MASS},
+
+        {"VISCOSITY", config.VISCOSITY},
+        {"INERTION_FACTOR", config.INERTION_FACTOR},
+        {"SPEED_FACTOR", config.SPEED_FACTOR},
+    };
+}
+
+#endif // ADAPTERS_JSON_H
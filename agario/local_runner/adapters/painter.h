@@ -0,0 +1,192 @@
+#ifndef ADAPTERS_PAINTER_H
+#define ADAPTERS_PAINTER_H
+
+#include "../core/mechanic.h"
+
+#include <QPainter>
+#include <QMap>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <qmath.h>
+
+
+inline void draw(QPainter &painter, const Food *food) {
+    painter.setPen(QPen(QBrush(Qt::black), 1));
+    painter.setBrush(Qt::GlobalColor(food->getC()));
+
+    int ix = int(food->getX()), iy = int(food->getY()), ir = int(food->getR());
+    painter.drawEllipse(QPoint(ix, iy), ir, ir);
+}
+
+inline void draw(QPainter &painter, const Ejection *eject) {
+    painter.setPen(QPen(QBrush(Qt::black), 1));
+    painter.setBrush(Qt::GlobalColor(eject->getC()));
+
+    int ix = int(eject->getX()), iy = int(eject->getY()), ir = int(eject->getR());
+    painter.drawEllipse(QPoint(ix, iy), ir, ir);
+}
+
+inline void draw(QPainter &painter, const Virus *virus) {
+    painter.setPen(QPen(QBrush(Qt::black), 1));
+
+    double x = virus->getX(), y = virus->getY(), radius = virus->getR();
+    for (double angle = 0; angle < M_PI; angle += M_PI / 12) {
+        double dx = qCos(angle) * radius;
+        double dy = qSin(angle) * radius;
+        painter.drawLine(x - dx, y - dy, x + dx, y + dy);
+    }
+}
+
+// Draw из ответа стратегии: {"Circles": [{X, Y, R, C, A}], "Lines": [{P: [{X, Y}], C, A}]}
+inline void draw_debug(QPainter &painter, const QJsonObject &debug_draw) {
+    for (auto _circle : debug_draw.value("Circles").toArray()) {
+        auto circle = _circle.toObject();
+        auto x = circle.value("X").toDouble();
+        auto y = circle.value("Y").toDouble();
+        auto r = circle.value("R").toDouble();
+        auto color = circle.value("C").toString("red");
+        auto alpha = circle.value("A").toDouble(1.0);
+        QColor brush_color(color);
+        brush_color.setAlphaF(alpha);
+        painter.setBrush(brush_color);
+        painter.setPen(Qt::NoPen);
+        painter.drawEllipse(QPointF(x, y), r, r);
+    }
+    for (auto _line : debug_draw.value("Lines").toArray()) {
+        auto line = _line.toObject();
+        double prev_x;
+        double prev_y;
+        bool is_first = true;
+        auto color = line.value("C").toString("black");
+        auto alpha = line.value("A").toDouble(1.0);
+        QColor brush_color(color);
+        brush_color.setAlphaF(alpha);
+        painter.setPen(QPen(QBrush(brush_color), 1));
+        for (auto _point : line.value("P").toArray()) {
+            auto point = _point.toObject();
+            auto x = point.value("X").toDouble();
+            auto y = point.value("Y").toDouble();
+            if (!is_first) {
+                painter.drawLine(QPointF(prev_x, prev_y), QPointF(x, y));
+            }
+            prev_x = x;
+            prev_y = y;
+            is_first = false;
+        }
+    }
+}
+
+inline void draw(QPainter &painter, const Player *player, bool show_speed=false, bool show_cmd=false) {
+    painter.setPen(QPen(QBrush(Qt::black), 1));
+    painter.setBrush(Qt::GlobalColor(player->getC()));
+
+    int ix = int(player->getX()), iy = int(player->getY()), ir = int(player->getR());
+    painter.drawEllipse(QPoint(ix, iy), ir, ir);
+    painter.drawText(ix - 4, iy + 4, QString::number(player->getM()));
+
+    if (show_speed) {
+        painter.setPen(QPen(QBrush(Qt::green), 1));
+        int speed_x = ix + player->get_speed() * qCos(player->getA()) * DRAW_SPEED_FACTOR;
+        int speed_y = iy + player->get_speed() * qSin(player->getA()) * DRAW_SPEED_FACTOR;
+        painter.drawLine(ix, iy, speed_x, speed_y);
+    }
+    if (show_cmd) {
+        painter.setPen(QPen(QBrush(Qt::red), 1));
+        std::pair<double, double> norm = player->get_direct();
+        painter.drawLine(ix, iy, norm.first, norm.second);
+    }
+    if (!player->debug_draw.empty()) {
+        QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromStdString(player->debug_draw));
+        draw_debug(painter, doc.object());
+    }
+    if (!player->debug_message.empty()) {
+        painter.setPen(QPen(QBrush(Qt::black), 1));
+        double x = 10;
+        double y = 15;
+        double dy = y;
+        for (auto message : QString::fromStdString(player->debug_message).split("; ")) {
+            painter.drawText(x, y, message);
+            y += dy;
+        }
+    }
+}
+
+inline void draw_vision_ellipse(QPainter &painter, const Player *player) {
+    double xVisionCenter = player->getX() + qCos(player->getA()) * VIS_SHIFT;
+    double yVisionCenter = player->getY() + qSin(player->getA()) * VIS_SHIFT;
+
+    painter.drawEllipse(QPointF(xVisionCenter, yVisionCenter), player->getVR(), player->getVR());
+}
+
+inline void clear_vision_area(QPainter &painter, const Player *player) {
+    painter.setPen(Qt::white);
+    painter.setBrush(Qt::white);
+
+    draw_vision_ellipse(painter, player);
+}
+
+inline void draw_vision_line(QPainter &painter, const Player *player) {
+    painter.setPen(QPen(QBrush(Qt::black), 1, Qt::DashLine));
+    painter.setBrush(Qt::transparent);
+
+    draw_vision_ellipse(painter, player);
+}
+
+inline bool is_seen_by_someone(const Mechanic *mechanic, const Circle *target, const QMap<int, bool> &player_vision) {
+    for (Player *player : mechanic->get_players()) {
+        if (player_vision.value(player->getId()) && player->can_see(target)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void paint_world(QPainter &painter, const Mechanic *mechanic, bool show_speed, bool show_fogs, bool show_cmd, const QMap<int, bool> &player_vision) {
+    bool fullVision = !player_vision.values().contains(true);
+
+    if (!fullVision) {
+        //draw fog everywhere
+        painter.save();
+        painter.setBrush(Qt::GlobalColor(Qt::gray));
+        painter.fillRect(0, 0, mechanic->get_config().GAME_WIDTH, mechanic->get_config().GAME_HEIGHT, Qt::Dense6Pattern);
+        painter.restore();
+
+        //clear fog for players with vision enabled
+        for (Player *player : mechanic->get_players()) {
+            if (player_vision.value(player->getId()))
+                clear_vision_area(painter, player);
+        }
+
+    }
+
+    if (show_fogs) {
+        for (Player *player : mechanic->get_players()) {
+            if (fullVision || is_seen_by_someone(mechanic, player, player_vision))
+                draw_vision_line(painter, player);
+        }
+    }
+
+    for (Food *food : mechanic->get_foods()) {
+        if (fullVision || is_seen_by_someone(mechanic, food, player_vision))
+            draw(painter, food);
+    }
+    for (Ejection *eject : mechanic->get_ejections()) {
+        if (fullVision || is_seen_by_someone(mechanic, eject, player_vision))
+            draw(painter, eject);
+    }
+    // мелкие рисуем первыми; порядок в механике не трогаем
+    PlayerArray players = mechanic->get_players();
+    std::sort(players.begin(), players.end(), [] (Player *lhs, Player *rhs) {
+        return lhs->getR() < rhs->getR();
+    });
+    for (Player *player : players) {
+        if (fullVision || player_vision.value(player->getId()) || is_seen_by_someone(mechanic, player, player_vision))
+            draw(painter, player, show_speed, show_cmd);
+    }
+    for (Virus *virus : mechanic->get_viruses()) {
+        draw(painter, virus);
+    }
+}
+
+#endif // ADAPTERS_PAINTER_H
@@ -0,0 +1,282 @@
+#ifndef PROCESS_STRATEGY_H
+#define PROCESS_STRATEGY_H
+
+#include "../core/strategy.h"
+#include "../core/json_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+// Стратегия во внешнем процессе: тот же построчный JSON-протокол, что у Custom
+// и сервера, но на pipe без Qt, чтобы игры можно было гонять в потоках.
+class ProcessStrategy : public Strategy
+{
+protected:
+    const GameConfig config;
+    pid_t pid;
+    int to_child, from_child;
+    bool is_running;
+    std::string error;
+
+    std::string message;
+    std::string received;
+    long long sum_waiting_ms;
+
+public:
+    explicit ProcessStrategy(int _id, const std::string &command, const GameConfig &_config) :
+        Strategy(_id),
+        config(_config),
+        pid(-1),
+        to_child(-1), from_child(-1),
+        is_running(false),
+        sum_waiting_ms(0)
+    {
+        int in_pipe[2], out_pipe[2];
+        if (pipe2(in_pipe, O_CLOEXEC) != 0) {
+            error = "Can't create pipe";
+            return;
+        }
+        if (pipe2(out_pipe, O_CLOEXEC) != 0) {
+            close(in_pipe[0]); close(in_pipe[1]);
+            error = "Can't create pipe";
+            return;
+        }
+        pid = fork();
+        if (pid == 0) {
+            // после fork в многопоточном процессе - только async-signal-safe вызовы
+            dup2(in_pipe[0], STDIN_FILENO);
+            dup2(out_pipe[1], STDOUT_FILENO);
+            int dev_null = open("/dev/null", O_WRONLY);
+            if (dev_null >= 0) {
+                dup2(dev_null, STDERR_FILENO);
+            }
+            execl("/bin/sh", "sh", "-c", command.c_str(), (char*)NULL);
+            _exit(127);
+        }
+        close(in_pipe[0]);
+        close(out_pipe[1]);
+        to_child = in_pipe[1];
+        from_child = out_pipe[0];
+        if (pid < 0) {
+            error = "Can't start process";
+            return;
+        }
+        is_running = true;
+
+        JsonWriter::write_config(message, config);
+        send(message);
+    }
+
+    virtual ~ProcessStrategy() {
+        if (to_child >= 0) close(to_child);
+        if (from_child >= 0) close(from_child);
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+    }
+
+    const std::string &get_error() const {
+        return error;
+    }
+
+    virtual Direct tickEvent(const PlayerArray &fragments, const CircleArray &objects) {
+        if (! is_running) {
+            return Direct(0, 0);
+        }
+        JsonWriter::write_state(message, fragments, objects);
+        if (! send(message)) {
+            return Direct(0, 0);
+        }
+
+        std::string line;
+        if (! read_line(line)) {
+            return Direct(0, 0);
+        }
+        Direct result(0, 0);
+        if (! parse_answer(line, result)) {
+            fail("No X or Y keys in answer json");
+            return Direct(0, 0);
+        }
+        return result;
+    }
+
+protected:
+    void fail(const std::string &reason) {
+        if (error.empty()) {
+            error = reason;
+        }
+        is_running = false;
+    }
+
+    bool send(const std::string &data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t count = write(to_child, data.data() + sent, data.size() - sent);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                fail("Can't write to process");
+                return false;
+            }
+            sent += size_t(count);
+        }
+        return true;
+    }
+
+    // ограничения по времени как у сервера: RESP_TIMEOUT на ответ и SUM_RESP_TIMEOUT на игру
+    bool read_line(std::string &line) {
+        auto started = std::chrono::steady_clock::now();
+        size_t end;
+        while ((end = received.find('\n')) == std::string::npos) {
+            auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - started).count();
+            long long left = std::min(config.RESP_TIMEOUT * 1000LL - waited,
+                                      config.SUM_RESP_TIMEOUT * 1000LL - sum_waiting_ms - waited);
+            if (left <= 0) {
+                fail("Can't wait for process answer (limit expired)");
+                return false;
+            }
+            pollfd fd = {from_child, POLLIN, 0};
+            int ready = poll(&fd, 1, int(left));
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            char buffer[4096];
+            ssize_t count = read(from_child, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                fail("Process finished");
+                return false;
+            }
+            received.append(buffer, size_t(count));
+        }
+        sum_waiting_ms += std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - started).count();
+        line.assign(received, 0, end);
+        received.erase(0, end + 1);
+        return true;
+    }
+
+    // Разбирает верхний уровень ответа {"X":..,"Y":..,"Split":..,"Eject":..};
+    // вложенные объекты (Debug, Draw, Sprite) пропускаются.
+    static bool parse_answer(const std::string &line, Direct &direct) {
+        const char *pos = line.c_str();
+        bool has_x = false, has_y = false;
+        skip_spaces(pos);
+        if (*pos != '{') {
+            return false;
+        }
+        pos++;
+        while (true) {
+            skip_spaces(pos);
+            if (*pos == '}' || *pos == '\0') {
+                break;
+            }
+            std::string key;
+            if (! read_string(pos, key)) {
+                return false;
+            }
+            skip_spaces(pos);
+            if (*pos != ':') {
+                return false;
+            }
+            pos++;
+            skip_spaces(pos);
+            if (key == "X" || key == "Y") {
+                char *end;
+                double value = std::strtod(pos, &end);
+                if (end == pos) {
+                    return false;
+                }
+                pos = end;
+                if (key == "X") {
+                    direct.x = value; has_x = true;
+                } else {
+                    direct.y = value; has_y = true;
+                }
+            } else if (key == "Split" || key == "Eject" || key == "Pause") {
+                bool value = std::strncmp(pos, "true", 4) == 0;
+                if (key == "Split") direct.split = value;
+                else if (key == "Eject") direct.eject = value;
+                else direct.pause = value;
+                skip_value(pos);
+            } else {
+                skip_value(pos);
+            }
+            skip_spaces(pos);
+            if (*pos == ',') {
+                pos++;
+            }
+        }
+        return has_x && has_y;
+    }
+
+    static void skip_spaces(const char *&pos) {
+        while (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n') {
+            pos++;
+        }
+    }
+
+    static bool read_string(const char *&pos, std::string &value) {
+        if (*pos != '"') {
+            return false;
+        }
+        pos++;
+        while (*pos != '"') {
+            if (*pos == '\0') {
+                return false;
+            }
+            if (*pos == '\\' && pos[1] != '\0') {
+                pos++;
+            }
+            value += *pos++;
+        }
+        pos++;
+        return true;
+    }
+
+    static void skip_value(const char *&pos) {
+        int depth = 0;
+        while (*pos != '\0') {
+            if (*pos == '"') {
+                std::string ignored;
+                read_string(pos, ignored);
+                if (depth == 0) return;
+                continue;
+            }
+            if (*pos == '{' || *pos == '[') {
+                depth++;
+            } else if (*pos == '}' || *pos == ']') {
+                if (depth == 0) return;
+                depth--;
+                if (depth == 0) {
+                    pos++;
+                    return;
+                }
+            } else if (*pos == ',' && depth == 0) {
+                return;
+            }
+            pos++;
+        }
+    }
+};
+
+#endif // PROCESS_STRATEGY_H
@@ -0,0 +1,172 @@
+#include "core/mechanic.h"
+#include "core/json_writer.h"
+#include "core/thread_pool.h"
+#include "batch/process_strategy.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <unistd.h>
+
+
+// Пакетный прогон: каждая строка файла сидов - отдельная игра, игроки по кругу
+// получают стратегии из командной строки. Результат - по строке JSON на игру.
+//
+//   batch_runner [-j потоков] [-o scores.jsonl] [-l] [-b|-B] seeds.txt strategy1 [strategy2 ...]
+//
+// Случайные параметры физики каждой игры выводятся из её сида (см.
+// GameConfig::from_env) и пишутся в запись игры, так что игра повторяется по
+// строке файла сидов.
+//
+// -l включает запись визио-логов в LOG_DIR (с индексом ключевых кадров .idx);
+// без него игры идут без лога.
+// -b пишет рядом двоичный лог (.bin), -B - двоичный с координатами во float.
+
+struct BatchOptions {
+    int threads;
+    bool write_logs;
+    int binary_logs;    // 0 - нет, 1 - двоичный лог, 2 - с координатами во float
+    std::string output;
+    std::vector<std::string> seeds;
+    std::vector<std::string> strategies;
+};
+
+static void usage() {
+    std::cerr << "usage: batch_runner [-j threads] [-o scores.jsonl] [-l] [-b|-B] seeds.txt strategy1 [strategy2 ...]" << std::endl;
+}
+
+static bool parse_options(int argc, char *argv[], BatchOptions &options) {
+    options.threads = int(std::thread::hardware_concurrency());
+    options.write_logs = false;
+    options.binary_logs = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:o:lbB")) != -1) {
+        switch (opt) {
+        case 'j': options.threads = std::atoi(optarg); break;
+        case 'o': options.output = optarg; break;
+        case 'l': options.write_logs = true; break;
+        case 'b': options.binary_logs = 1; break;
+        case 'B': options.binary_logs = 2; break;
+        default: return false;
+        }
+    }
+    if (argc - optind < 2) {
+        return false;
+    }
+
+    std::ifstream seeds(argv[optind]);
+    if (! seeds.is_open()) {
+        std::cerr << "cannot read " << argv[optind] << std::endl;
+        return false;
+    }
+    std::string seed;
+    while (std::getline(seeds, seed)) {
+        if (! seed.empty()) {
+            options.seeds.push_back(seed);
+        }
+    }
+    for (int I = optind + 1; I < argc; I++) {
+        options.strategies.push_back(argv[I]);
+    }
+    return true;
+}
+
+// {"seed":"...","tick":N,"config":{..},"scores":{"1":..},"errors":{"1":".."}}
+static std::string play_game(const std::string &seed, const BatchOptions &options) {
+    const GameConfig config = GameConfig::from_system(seed);
+    Mechanic mechanic(config);
+    mechanic.set_log_detached(! options.write_logs);
+    mechanic.get_logger()->set_index(options.write_logs);
+    if (options.write_logs && options.binary_logs) {
+        mechanic.get_logger()->set_binary(true, options.binary_logs == 2);
+    }
+
+    std::vector<ProcessStrategy*> strategies;
+    mechanic.init_objects(seed, [&options, &config, &strategies] (Player *player) -> Strategy* {
+        int pId = player->getId();
+        const std::string &command = options.strategies[(pId - 1) % options.strategies.size()];
+        ProcessStrategy *strategy = new ProcessStrategy(pId, command, config);
+        strategies.push_back(strategy);
+        return strategy;
+    });
+
+    bool is_paused = false;
+    int tick = 0;
+    while (tick < config.GAME_TICKS && ! mechanic.known()) {
+        tick = mechanic.tickEvent(is_paused);
+    }
+    if (options.write_logs) {
+        mechanic.get_logger()->rewrite_game_ticks(tick);
+        mechanic.get_logger()->flush();
+    }
+
+    std::string record = "{\"seed\":";
+    JsonWriter::append_string(record, seed);
+    std::string physics;
+    JsonWriter::write_config(physics, config);
+    physics.pop_back(); // '\n'
+    record += ",\"tick\":" + std::to_string(tick) + ",\"config\":" + physics + ",\"scores\":{";
+    bool first = true;
+    for (auto &score : mechanic.get_scores()) {
+        if (! first) record += ',';
+        record += "\"" + std::to_string(score.first) + "\":" + std::to_string(score.second);
+        first = false;
+    }
+    record += "},\"errors\":{";
+    first = true;
+    for (ProcessStrategy *strategy : strategies) {
+        if (strategy->get_error().empty()) {
+            continue;
+        }
+        if (! first) record += ',';
+        record += "\"" + std::to_string(strategy->getId()) + "\":";
+        JsonWriter::append_string(record, strategy->get_error());
+        first = false;
+    }
+    record += "}}\n";
+    return record;
+}
+
+int main(int argc, char *argv[]) {
+    BatchOptions options;
+    if (! parse_options(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+    // упавшая стратегия не должна ронять весь прогон
+    signal(SIGPIPE, SIG_IGN);
+
+    std::ofstream file;
+    if (! options.output.empty()) {
+        file.open(options.output, std::ios::out | std::ios::trunc);
+        if (! file.is_open()) {
+            std::cerr << "cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = options.output.empty()? std::cout : file;
+    std::mutex out_lock;
+    int finished = 0;
+
+    WorkStealingPool pool(options.threads);
+    for (const std::string &seed : options.seeds) {
+        pool.submit([&, seed] {
+            std::string record = play_game(seed, options);
+
+            std::lock_guard<std::mutex> guard(out_lock);
+            out << record << std::flush;
+            finished++;
+            std::cerr << "games " << finished << "/" << options.seeds.size() << "\r";
+        });
+    }
+    pool.wait();
+    std::cerr << std::endl;
+    return 0;
+}
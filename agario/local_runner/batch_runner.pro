@@ -0,0 +1,14 @@
+TEMPLATE = app
+
+CONFIG += c++11 warn_off console thread
+CONFIG -= qt app_bundle
+
+TARGET = batch_runner
+
+include(core/core.pri)
+
+HEADERS  += batch/process_strategy.h
+
+SOURCES += batch_runner.cpp
+
+LIBS += -lpthread
@@ -12,6 +12,10 @@ server_runner)
   PROJECT="server_runner"
   TARGET="server_runner"
   ;;
+batch_runner)
+  PROJECT="batch_runner"
+  TARGET="batch_runner"
+  ;;
 *)
   PROJECT="local_runner"
   TARGET="local_runner.app"
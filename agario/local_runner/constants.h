@@ -1,6 +1,8 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+#include "core/constants.h"
+
 #include <QString>
 #include <QVector>
 #include <QDebug>
@@ -8,203 +10,27 @@
 #include <QTime>
 #include <qglobal.h>
 #include <QProcessEnvironment>
-#include <random>
 #include <QSettings>
-#include <QJsonObject>
 
 // yes ugly
 #define DEFINE_QSETTINGS(VARIABLE_NAME) QSettings VARIABLE_NAME("LocalRunner.ini", QSettings::IniFormat)
 
-struct Constants
-{
-private:
-    Constants() {}
-    ~Constants() {}
-
-    Constants(Constants const&) = delete;
-    Constants& operator= (Constants const&) = delete;
-
-public:
-    // name                     // default
-
-    QString LOG_DIR;            // /var/tmp/
-    int GAME_TICKS;             // 75000 ticks
-    int GAME_WIDTH;             // 660
-    int GAME_HEIGHT;            // 660
-    int SUM_RESP_TIMEOUT;       // 500 secs
-    int RESP_TIMEOUT;           // 5 sec
-
-    int TICK_MS;                // 16 ms
-    int BASE_TICK;              // every 50 ticks
-    QString SEED;               // from std::random_device
-
-    double INERTION_FACTOR;     // 10.0
-    double VISCOSITY;           // 0.25
-    double SPEED_FACTOR;        // 25.0
-
-    double FOOD_MASS;           // 1.0
-    double VIRUS_RADIUS;        // 22.0
-    double VIRUS_SPLIT_MASS;    // 80.0
-    int MAX_FRAGS_CNT;          // 10
-    int TICKS_TIL_FUSION;       // 250 ticks
-
-    static Constants &instance() {
-        static Constants ins;
-        return ins;
-    }
-
-    static QString generate_seed(uint length = 10) {
-        std::random_device dev;
-        const QString alphabet("ABCDEFGHIJKLMNOPQRSTUVWXYZ234567");
-        std::uniform_int_distribution<> dist(0, static_cast<int>(alphabet.length() - 1));
-
-        QString seed;
-        while (seed.length() < length) {
-            seed += alphabet[static_cast<uint>(dist(dev))];
-        }
-
-        return seed;
-    }
-
-    static Constants &initialize(const QProcessEnvironment &env) {
-        srand(time(NULL));
-        Constants& c = instance();
-
-#define SET_STRING_CONSTANT(NAME, DEFAULT) do {                                \
-            c.NAME = env.value(#NAME, DEFAULT);                                \
-        } while(false)
-
-#define SET_CONSTANT(NAME, DEFAULT, CONVERT) do {                              \
-            c.NAME = env.value(#NAME, QString::number(DEFAULT)).CONVERT();     \
-        } while(false)
-
-        SET_STRING_CONSTANT(LOG_DIR, "/var/tmp/");
-        SET_CONSTANT(GAME_TICKS, 75000, toInt);
-        SET_CONSTANT(TICK_MS, 16, toInt);
-        SET_CONSTANT(BASE_TICK, 50, toInt);
-        SET_CONSTANT(RESP_TIMEOUT, 5, toInt);
-        SET_CONSTANT(GAME_WIDTH, 990, toInt);
-        SET_CONSTANT(GAME_HEIGHT, 990, toInt);
+inline GameConfig load_config(const QProcessEnvironment &env) {
+    GameConfig c = GameConfig::from_env([&env] (const std::string &name, const std::string &value) {
+        return env.value(QString::fromStdString(name), QString::fromStdString(value)).toStdString();
+    });
 #if defined LOCAL_RUNNER
-        SET_CONSTANT(SUM_RESP_TIMEOUT, 500, toInt);
-#elif defined SERVER_RUNNER
-        SET_CONSTANT(SUM_RESP_TIMEOUT, 150, toInt);
+    c.SUM_RESP_TIMEOUT = env.value("SUM_RESP_TIMEOUT", "500").toInt();
 #endif
-        SET_CONSTANT(INERTION_FACTOR, random_double(1.0, 20.0), toDouble);
-        SET_CONSTANT(VISCOSITY, random_double(0.05, 0.5), toDouble);
-        SET_CONSTANT(SPEED_FACTOR, random_double(25.0, 100.0), toDouble);
-        SET_CONSTANT(FOOD_MASS, random_double(1.0, 4.0), toDouble);
-        SET_CONSTANT(VIRUS_RADIUS, random_double(15.0, 40.0), toDouble);
-        SET_CONSTANT(VIRUS_SPLIT_MASS, random_double(50.0, 100.0), toDouble);
-        SET_CONSTANT(MAX_FRAGS_CNT, random_int(4, 16), toInt);
-        SET_CONSTANT(TICKS_TIL_FUSION, random_int(150, 500), toInt);
-#undef SET_STRING_CONSTANT
-#undef SET_CONSTANT
-
-        c.SEED = env.value("SEED", "");
-        if (c.SEED.isEmpty()) {
-            c.SEED = generate_seed();
-        }
-
-        return c;
-    }
-
-    QJsonObject toJson() const {
-        return {
-            {"GAME_WIDTH", GAME_WIDTH},
-            {"GAME_HEIGHT", GAME_HEIGHT},
-            {"GAME_TICKS", GAME_TICKS},
+    return c;
+}
 
-            {"FOOD_MASS", FOOD_MASS},
-            {"MAX_FRAGS_CNT", MAX_FRAGS_CNT},
-            {"TICKS_TIL_FUSION", TICKS_TIL_FUSION},
-            {"VIRUS_RADIUS", VIRUS_RADIUS},
-            {"VIRUS_SPLIT_MASS", VIRUS_SPLIT_MASS},
-
-            {"VISCOSITY", VISCOSITY},
-            {"INERTION_FACTOR", INERTION_FACTOR},
-            {"SPEED_FACTOR", SPEED_FACTOR},
-        };
-    }
-
-private:
-    static double random_double(double lo, double hi) {
-      return lo + (hi - lo) * (double) rand() / (double) RAND_MAX;
-    }
-
-    static int random_int(int lo, int hi) {  // NOTE: Not equally likely.
-      return lo + rand() % (hi - lo + 1);
-    }
-};
-
-const QString LOG_FILE = "visio_{1}.log";
-const QString DEBUG_FILE = "{1}.log";
-const QString DUMP_FILE = "{1}_dump.log";
 const QString SCORES_FILE = "scores.json";
 
 const QString MAIN_JSON_KEY = "visio";
 const QString DEBUG_JSON_KEY = "debug";
 const QString SCORES_JSON_KEY = "scores";
 
-const int START_FOOD_SETS = 4;
-const int ADD_FOOD_SETS = 2;
-const int ADD_FOOD_DELAY = 40;
-const double FOOD_RADIUS = 2.5;
-//const double FOOD_MASS = 1.0;
-
-const int START_VIRUS_SETS = 1;
-const int ADD_VIRUS_SETS = 1;
-const int ADD_VIRUS_DELAY = 1200;
-//const double VIRUS_RADIUS = 22.0;
-const double VIRUS_MASS = 40.0;
-
-const int START_PLAYER_SETS = 1;
-const int START_PLAYER_OFFSET = 400;
-const double PLAYER_RADIUS_FACTOR = 2;
-const double PLAYER_MASS = 40.0;
-const double PLAYER_RADIUS = PLAYER_RADIUS_FACTOR * std::sqrt(PLAYER_MASS);
-
-const double VIS_FACTOR = 4.0; // vision = radius * VF
-const double VIS_FACTOR_FR = 2.5; // vision = radius * VFF * qSqrt(fragments.count())
-const double VIS_SHIFT = 10.0; // dx = qCos(angle) * VS; dy = qSin(angle) * VS
-const double DRAW_SPEED_FACTOR = 14.0;
-
-const double COLLISION_POWER = 20.;
-const double MASS_EAT_FACTOR = 1.20; // mass > food.mass * MEF
-const double DIAM_EAT_FACTOR = 2./3.; // dist - eject->getR() + (eject->getR() * 2) * DIAM_EAT_FACTOR < radius
-
-const double RAD_HURT_FACTOR = 2./3.; // (radius * RHF + player.radius) > dist
-const double MIN_BURST_MASS = 60.0; // MBM * 2 < mass
-//const int MAX_FRAGS_CNT = 10;
-const double BURST_START_SPEED = 8.0;
-const double BURST_ANGLE_SPECTRUM = M_PI; // angle - BAM / 2 + I*BAM / frags_cnt
-//const double PLAYER_VISCOSITY = 0.25;
-
-//const int TICKS_TIL_FUSION = 250;
-
-const double MIN_SPLIT_MASS = 120.0; // MSM < mass
-const double SPLIT_START_SPEED = 9.0;
-
-const double MIN_EJECT_MASS = 40.0;
-const double EJECT_START_SPEED = 8.0;
-const double EJECT_RADIUS = 4.0;
-const double EJECT_MASS = 15.0;
-//const double EJECT_VISCOSITY = 0.25;
-
-//const double VIRUS_VISCOSITY = 0.25;
-const double VIRUS_SPLIT_SPEED = 8.0;
-//const double VIRUS_SPLIT_MASS = 80.0;
-
-const double MIN_SHRINK_MASS = 100;
-const double SHRINK_FACTOR = 0.01; // (-1) * (mass - MSM) * SF
-const int SHRINK_EVERY_TICK = 50;
-const double BURST_BONUS = 5.0; // mass += BB
-
-const int SCORE_FOR_FOOD = 1;
-const int SCORE_FOR_PLAYER = 10;
-const int SCORE_FOR_LAST = 100;
-const int SCORE_FOR_BURST = 2;
-
 // TCP Server
 const QString HOST = "127.0.0.1";
 const int PORT = 8000;
@@ -223,8 +49,5 @@ const QString RESP_EXPIRED = "Ожидание ответа превышено!"
 const QString SUM_RESP_EXPIRED = "Суммарное ожидание клиента превышено. Клиент будет отключён!";
 const QString CLIENT_DISCONNECTED = "Решение отключилось от механики до окончания!";
 
-const int MAX_GAME_FOOD = 2000;
-const int MAX_GAME_VIRUS = 20;
-
 
 #endif // CONSTANTS_H
@@ -0,0 +1,241 @@
+#ifndef CORE_CONSTANTS_H
+#define CORE_CONSTANTS_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+
+// (name, default) -> value; источник параметров (окружение, лог повтора и т.п.)
+typedef std::function<std::string(const std::string&, const std::string&)> EnvLookup;
+
+// Параметры одной игры. Передаётся по значению в Mechanic и по ссылке в методы
+// сущностей, поэтому в одном процессе могут идти игры с разными параметрами.
+struct GameConfig
+{
+    // name                     // default
+
+    std::string LOG_DIR;        // /var/tmp/
+    int GAME_TICKS;             // 75000 ticks
+    int GAME_WIDTH;             // 660
+    int GAME_HEIGHT;            // 660
+    int SUM_RESP_TIMEOUT;       // 150 secs
+    int RESP_TIMEOUT;           // 5 sec
+
+    int TICK_MS;                // 16 ms
+    int BASE_TICK;              // every 50 ticks
+    std::string SEED;           // from std::random_device
+    int BINARY_LOG;             // 0 (1 - сервер пишет рядом с логом точный .log.bin)
+
+    double INERTION_FACTOR;     // 10.0
+    double VISCOSITY;           // 0.25
+    double SPEED_FACTOR;        // 25.0
+
+    double FOOD_MASS;           // 1.0
+    double VIRUS_RADIUS;        // 22.0
+    double VIRUS_SPLIT_MASS;    // 80.0
+    int MAX_FRAGS_CNT;          // 10
+    int TICKS_TIL_FUSION;       // 250 ticks
+
+    GameConfig() :
+        LOG_DIR("/var/tmp/"),
+        GAME_TICKS(75000),
+        GAME_WIDTH(990),
+        GAME_HEIGHT(990),
+        SUM_RESP_TIMEOUT(150),
+        RESP_TIMEOUT(5),
+        TICK_MS(16),
+        BASE_TICK(50),
+        BINARY_LOG(0),
+        INERTION_FACTOR(10.0),
+        VISCOSITY(0.25),
+        SPEED_FACTOR(25.0),
+        FOOD_MASS(1.0),
+        VIRUS_RADIUS(22.0),
+        VIRUS_SPLIT_MASS(80.0),
+        MAX_FRAGS_CNT(10),
+        TICKS_TIL_FUSION(250)
+    {}
+
+    static std::string generate_seed(unsigned length = 10) {
+        std::random_device dev;
+        const std::string alphabet("ABCDEFGHIJKLMNOPQRSTUVWXYZ234567");
+        std::uniform_int_distribution<> dist(0, static_cast<int>(alphabet.length() - 1));
+
+        std::string seed;
+        while (seed.length() < length) {
+            seed += alphabet[static_cast<unsigned>(dist(dev))];
+        }
+
+        return seed;
+    }
+
+    // Случайные параметры физики без physics_seed берутся из rand(), с ним -
+    // из генератора, заведённого от physics_seed: так пакетный прогон
+    // воспроизводит игру по её сиду.
+    static GameConfig from_env(const EnvLookup &env, const std::string &physics_seed="") {
+        std::mt19937 physics_rand;
+        if (physics_seed.empty()) {
+            // не time(NULL): сервер матчей читает конфиг на каждую игру, и игры
+            // одной секунды получили бы одинаковые параметры
+            srand(std::random_device()());
+        } else {
+            std::seed_seq seq(physics_seed.begin(), physics_seed.end());
+            physics_rand.seed(seq);
+        }
+        RandomSource next = [&physics_seed, &physics_rand] () -> int {
+            if (physics_seed.empty()) {
+                return rand();
+            }
+            return int(physics_rand() % (unsigned(RAND_MAX) + 1));
+        };
+        GameConfig c;
+
+#define SET_STRING_CONSTANT(NAME, DEFAULT) do {                                \
+            c.NAME = env(#NAME, DEFAULT);                                      \
+        } while(false)
+
+#define SET_CONSTANT(NAME, DEFAULT, CONVERT) do {                              \
+            c.NAME = CONVERT(env(#NAME, number(DEFAULT)));                     \
+        } while(false)
+
+        SET_STRING_CONSTANT(LOG_DIR, "/var/tmp/");
+        SET_CONSTANT(GAME_TICKS, 75000, to_int);
+        SET_CONSTANT(TICK_MS, 16, to_int);
+        SET_CONSTANT(BASE_TICK, 50, to_int);
+        SET_CONSTANT(BINARY_LOG, 0, to_int);
+        SET_CONSTANT(RESP_TIMEOUT, 5, to_int);
+        SET_CONSTANT(GAME_WIDTH, 990, to_int);
+        SET_CONSTANT(GAME_HEIGHT, 990, to_int);
+        SET_CONSTANT(SUM_RESP_TIMEOUT, 150, to_int);
+        SET_CONSTANT(INERTION_FACTOR, random_double(next, 1.0, 20.0), to_double);
+        SET_CONSTANT(VISCOSITY, random_double(next, 0.05, 0.5), to_double);
+        SET_CONSTANT(SPEED_FACTOR, random_double(next, 25.0, 100.0), to_double);
+        SET_CONSTANT(FOOD_MASS, random_double(next, 1.0, 4.0), to_double);
+        SET_CONSTANT(VIRUS_RADIUS, random_double(next, 15.0, 40.0), to_double);
+        SET_CONSTANT(VIRUS_SPLIT_MASS, random_double(next, 50.0, 100.0), to_double);
+        SET_CONSTANT(MAX_FRAGS_CNT, random_int(next, 4, 16), to_int);
+        SET_CONSTANT(TICKS_TIL_FUSION, random_int(next, 150, 500), to_int);
+#undef SET_STRING_CONSTANT
+#undef SET_CONSTANT
+
+        c.SEED = env("SEED", "");
+        if (c.SEED.empty()) {
+            c.SEED = generate_seed();
+        }
+
+        return c;
+    }
+
+    static GameConfig from_system(const std::string &physics_seed="") {
+        return from_env([] (const std::string &name, const std::string &value) {
+            const char *env_value = std::getenv(name.c_str());
+            return env_value? std::string(env_value) : value;
+        }, physics_seed);
+    }
+
+private:
+    // значения от 0 до RAND_MAX, как у rand()
+    typedef std::function<int()> RandomSource;
+
+    static double random_double(const RandomSource &next, double lo, double hi) {
+      return lo + (hi - lo) * (double) next() / (double) RAND_MAX;
+    }
+
+    static int random_int(const RandomSource &next, int lo, int hi) {  // NOTE: Not equally likely.
+      return lo + next() % (hi - lo + 1);
+    }
+
+    // как QString::number по умолчанию: 6 значащих цифр
+    static std::string number(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%g", value);
+        return buffer;
+    }
+
+    static std::string number(int value) {
+        return std::to_string(value);
+    }
+
+    static int to_int(const std::string &value) {
+        return int(std::strtol(value.c_str(), NULL, 10));
+    }
+
+    static double to_double(const std::string &value) {
+        return std::strtod(value.c_str(), NULL);
+    }
+};
+
+const std::string LOG_FILE = "visio_{1}.log";
+const std::string DEBUG_FILE = "{1}.log";
+const std::string DUMP_FILE = "{1}_dump.log";
+
+const int START_FOOD_SETS = 4;
+const int ADD_FOOD_SETS = 2;
+const int ADD_FOOD_DELAY = 40;
+const double FOOD_RADIUS = 2.5;
+//const double FOOD_MASS = 1.0;
+
+const int START_VIRUS_SETS = 1;
+const int ADD_VIRUS_SETS = 1;
+const int ADD_VIRUS_DELAY = 1200;
+//const double VIRUS_RADIUS = 22.0;
+const double VIRUS_MASS = 40.0;
+
+const int START_PLAYER_SETS = 1;
+const int START_PLAYER_OFFSET = 400;
+const double PLAYER_RADIUS_FACTOR = 2;
+const double PLAYER_MASS = 40.0;
+const double PLAYER_RADIUS = PLAYER_RADIUS_FACTOR * std::sqrt(PLAYER_MASS);
+
+const double VIS_FACTOR = 4.0; // vision = radius * VF
+const double VIS_FACTOR_FR = 2.5; // vision = radius * VFF * qSqrt(fragments.count())
+const double VIS_SHIFT = 10.0; // dx = qCos(angle) * VS; dy = qSin(angle) * VS
+const double DRAW_SPEED_FACTOR = 14.0;
+
+const double COLLISION_POWER = 20.;
+const double MASS_EAT_FACTOR = 1.20; // mass > food.mass * MEF
+const double DIAM_EAT_FACTOR = 2./3.; // dist - eject->getR() + (eject->getR() * 2) * DIAM_EAT_FACTOR < radius
+
+const double RAD_HURT_FACTOR = 2./3.; // (radius * RHF + player.radius) > dist
+const double MIN_BURST_MASS = 60.0; // MBM * 2 < mass
+//const int MAX_FRAGS_CNT = 10;
+const double BURST_START_SPEED = 8.0;
+const double BURST_ANGLE_SPECTRUM = M_PI; // angle - BAM / 2 + I*BAM / frags_cnt
+//const double PLAYER_VISCOSITY = 0.25;
+
+//const int TICKS_TIL_FUSION = 250;
+
+const double MIN_SPLIT_MASS = 120.0; // MSM < mass
+const double SPLIT_START_SPEED = 9.0;
+
+const double MIN_EJECT_MASS = 40.0;
+const double EJECT_START_SPEED = 8.0;
+const double EJECT_RADIUS = 4.0;
+const double EJECT_MASS = 15.0;
+//const double EJECT_VISCOSITY = 0.25;
+
+//const double VIRUS_VISCOSITY = 0.25;
+const double VIRUS_SPLIT_SPEED = 8.0;
+//const double VIRUS_SPLIT_MASS = 80.0;
+
+const double MIN_SHRINK_MASS = 100;
+const double SHRINK_FACTOR = 0.01; // (-1) * (mass - MSM) * SF
+const int SHRINK_EVERY_TICK = 50;
+const double BURST_BONUS = 5.0; // mass += BB
+
+const int SCORE_FOR_FOOD = 1;
+const int SCORE_FOR_PLAYER = 10;
+const int SCORE_FOR_LAST = 100;
+const int SCORE_FOR_BURST = 2;
+
+const int MAX_GAME_FOOD = 2000;
+const int MAX_GAME_VIRUS = 20;
+
+const double SPATIAL_CELL_SIZE = 40.0; // cell side of the uniform grid used by spatial queries
+
+
+#endif // CORE_CONSTANTS_H
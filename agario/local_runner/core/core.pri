@@ -0,0 +1,36 @@
+# Игровая механика без Qt: подключается раннерами и собирается отдельно через core.pro
+
+HEADERS += $$PWD/constants.h \
+    $$PWD/fixed_physics.h \
+    $$PWD/mechanic.h \
+    $$PWD/spatial_grid.h \
+    $$PWD/logger.h \
+    $$PWD/log_format.h \
+    $$PWD/replay_format.h \
+    $$PWD/replay_index.h \
+    $$PWD/spsc_queue.h \
+    $$PWD/shared_buffer.h \
+    $$PWD/thread_pool.h \
+    $$PWD/mapped_file.h \
+    $$PWD/replay_log.h \
+    $$PWD/strategy.h \
+    $$PWD/world_state.h \
+    $$PWD/motion_array.h \
+    $$PWD/motion_kernels.h \
+    $$PWD/json_writer.h \
+    $$PWD/json_reader.h \
+    $$PWD/wire_format.h \
+    $$PWD/entities/circle.h \
+    $$PWD/entities/food.h \
+    $$PWD/entities/virus.h \
+    $$PWD/entities/player.h \
+    $$PWD/entities/ejection.h
+
+SOURCES += $$PWD/mechanic.cpp
+
+# отдельные ядра физики для наборов параметров из fixed_physics.h
+fixed_physics: DEFINES += FIXED_PHYSICS
+# AVX для шага выбросов и вирусов (motion_kernels.h); без него - SSE2 на x86-64
+simd_avx: QMAKE_CXXFLAGS += -mavx
+
+LIBS += -lz
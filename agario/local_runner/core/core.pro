@@ -0,0 +1,9 @@
+# Статическая библиотека механики для headless-сборок (без Qt)
+
+TEMPLATE = lib
+CONFIG += staticlib c++11 warn_off thread
+CONFIG -= qt app_bundle
+
+TARGET = agario_core
+
+include(core.pri)
@@ -1,12 +1,19 @@
 #ifndef CIRCLE_H
 #define CIRCLE_H
 
-#include "constants.h"
+#include "../constants.h"
 
-#include <QJsonObject>
-#include <QJsonValue>
-#include <QPainter>
-#include <QPoint>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+// как qAbs: для -0.0 возвращает -0.0, от этого зависит побитовое совпадение логов
+template <typename T>
+inline T abs_value(const T &value) {
+    return value >= 0 ? value : -value;
+}
 
 
 struct Direct
@@ -19,15 +26,17 @@ public:
     bool eject;
     bool pause;
 
-    void limit() {
+    // Config - GameConfig или набор из fixed_physics.h
+    template <typename Config>
+    void limit(const Config &config) {
 
-        if (this->x > Constants::instance().GAME_WIDTH) {
-            this->x = Constants::instance().GAME_WIDTH;
+        if (this->x > config.GAME_WIDTH) {
+            this->x = config.GAME_WIDTH;
         } else if (this->x < 0) {
             this->x = 0;
         }
-        if (this->y > Constants::instance().GAME_HEIGHT) {
-            this->y = Constants::instance().GAME_HEIGHT;
+        if (this->y > config.GAME_HEIGHT) {
+            this->y = config.GAME_HEIGHT;
         } else if (this->y < 0) {
             this->y = 0;
         }
@@ -58,8 +67,8 @@ public:
         return id;
     }
 
-    QString id_to_str() const {
-        return QString::number(id);
+    std::string id_to_str() const {
+        return std::to_string(id);
     }
 
     double getX() const {
@@ -94,10 +103,14 @@ public:
         return false;
     }
 
+    virtual bool is_ejection() const {
+        return false;
+    }
+
 public:
     double calc_dist(double from_x, double from_y) const {
         double dx = x - from_x, dy = y - from_y;
-        return qSqrt(dx * dx + dy * dy);
+        return std::sqrt(dx * dx + dy * dy);
     }
 
     double calc_qdist(double from_x, double from_y) const {
@@ -116,11 +129,9 @@ public:
         double dR = radius + _radius;
         return qdist < dR * dR;
     }
-
-    virtual QJsonObject toJson(bool mine=false) const = 0;
 };
 
-typedef QVector<Circle*> CircleArray;
+typedef std::vector<Circle*> CircleArray;
 
 
 #endif // CIRCLE_H
@@ -0,0 +1,68 @@
+#ifndef EJECTION_H
+#define EJECTION_H
+
+#include "circle.h"
+
+
+class Ejection : public Circle
+{
+protected:
+    int color;
+    int player;
+    double speed;
+    double angle;
+
+public:
+    explicit Ejection(int _id, double _x, double _y, double _radius, double _mass, int player) :
+        Circle(_id, _x, _y, _radius, _mass),
+        speed(0.0),
+        angle(0.0),
+        player(player)
+    {
+        color = rand() % 14 + 4;
+    }
+
+    virtual ~Ejection() {}
+
+    int getC() const {
+        return color;
+    }
+
+    double getA() const {
+        return angle;
+    }
+
+    virtual bool is_my_eject(Circle *player) const {
+        return this->player == player->getId();
+    }
+
+    virtual bool is_food() const {
+        return true;
+    }
+
+    virtual bool is_ejection() const {
+        return true;
+    }
+
+public:
+    void set_impulse(double _speed, double _angle) {
+        speed = abs_value(_speed);
+        angle = _angle;
+    }
+
+    int get_player() const {
+        return player;
+    }
+
+    double get_speed() const {
+        return speed;
+    }
+
+    double get_angle() const {
+        return angle;
+    }
+};
+
+typedef std::vector<Ejection*> EjectionArray;
+
+#endif // EJECTION_H
@@ -0,0 +1,34 @@
+#ifndef FOOD_H
+#define FOOD_H
+
+#include "circle.h"
+
+
+class Food : public Circle
+{
+protected:
+    int color;
+
+public:
+    explicit Food(int _id, double _x, double _y, double _radius, double _mass) :
+        Circle(_id, _x, _y, _radius, _mass)
+    {
+        color = rand() % 14 + 4;
+    }
+
+    virtual ~Food() {}
+
+    int getC() const {
+        return color;
+    }
+
+    virtual bool is_food() const {
+        return true;
+    }
+
+};
+
+typedef std::vector<Food*> FoodArray;
+
+
+#endif // FOOD_H
@@ -3,8 +3,6 @@
 
 #include "circle.h"
 #include "ejection.h"
-#include <QJsonArray>
-#include <QJsonDocument>
 
 
 class Player : public Circle
@@ -12,8 +10,8 @@ class Player : public Circle
 public:
     bool is_fast;
     int fuse_timer;
-    QString debug_message;
-    QJsonObject debug_draw;
+    std::string debug_message;
+    std::string debug_draw; // JSON-объект Draw из ответа стратегии
 
 protected:
     double speed, angle;
@@ -33,18 +31,30 @@ public:
         cmd_x(0), cmd_y(0)
     {
         color = _id + 7;
-        if (fId > 0) {
-            fuse_timer = Constants::instance().TICKS_TIL_FUSION;
-        }
     }
 
     virtual ~Player() {}
 
-    QString id_to_str() const {
+    // Копия без отладочного вывода стратегии: форку он не нужен, а копирование
+    // строк выделяло бы память на каждом снапшоте (см. Mechanic::snapshot).
+    Player without_debug() const {
+        Player copy(id, x, y, radius, mass, fragmentId);
+        copy.is_fast = is_fast;
+        copy.fuse_timer = fuse_timer;
+        copy.speed = speed;
+        copy.angle = angle;
+        copy.color = color;
+        copy.vision_radius = vision_radius;
+        copy.cmd_x = cmd_x;
+        copy.cmd_y = cmd_y;
+        return copy;
+    }
+
+    std::string id_to_str() const {
         if (fragmentId > 0) {
-            return QString::number(id) + "." + QString::number(fragmentId);
+            return std::to_string(id) + "." + std::to_string(fragmentId);
         }
-        return QString::number(id);
+        return std::to_string(id);
     }
 
     int get_fId() const {
@@ -67,8 +77,8 @@ public:
         return true;
     }
 
-    QPair<double, double> get_direct() const {
-        return QPair<double, double>(cmd_x, cmd_y);
+    std::pair<double, double> get_direct() const {
+        return std::pair<double, double>(cmd_x, cmd_y);
     }
 
     double getVR() const {
@@ -77,15 +87,16 @@ public:
 
 public:
     void set_impulse(double new_speed, double new_angle) {
-        speed = qAbs(new_speed);
+        speed = abs_value(new_speed);
         angle = new_angle;
         is_fast = true;
     }
 
-    void apply_viscosity(double usual_speed) {
+    template <typename Config>
+    void apply_viscosity(double usual_speed, const Config &config) {
         // если на этом тике не снизим скорость достаточно - летим дальше
-        if (speed - Constants::instance().VISCOSITY > usual_speed) {
-            speed -= Constants::instance().VISCOSITY;
+        if (speed - config.VISCOSITY > usual_speed) {
+            speed -= config.VISCOSITY;
         } else {
             // иначе выставляем максимальную скорость и выходим из режима полёта
             speed = usual_speed;
@@ -93,81 +104,13 @@ public:
         }
     }
 
-    void draw(QPainter &painter, bool show_speed=false, bool show_cmd=false) const {
-        painter.setPen(QPen(QBrush(Qt::black), 1));
-        painter.setBrush(Qt::GlobalColor(color));
-
-        int ix = int(x), iy = int(y), ir = int(radius);
-        painter.drawEllipse(QPoint(ix, iy), ir, ir);
-        painter.drawText(ix - 4, iy + 4, QString::number(mass));
-
-        if (show_speed) {
-            painter.setPen(QPen(QBrush(Qt::green), 1));
-            int speed_x = ix + speed * qCos(angle) * DRAW_SPEED_FACTOR;
-            int speed_y = iy + speed * qSin(angle) * DRAW_SPEED_FACTOR;
-            painter.drawLine(ix, iy, speed_x, speed_y);
-        }
-        if (show_cmd) {
-            painter.setPen(QPen(QBrush(Qt::red), 1));
-            QPair<double, double> norm = get_direct();
-            painter.drawLine(ix, iy, norm.first, norm.second);
-        }
-        if (!debug_draw.isEmpty()) {
-            for (auto _circle : debug_draw.value("Circles").toArray()) {
-                auto circle = _circle.toObject();
-                auto x = circle.value("X").toDouble();
-                auto y = circle.value("Y").toDouble();
-                auto r = circle.value("R").toDouble();
-                auto color = circle.value("C").toString("red");
-                auto alpha = circle.value("A").toDouble(1.0);
-                QColor brush_color(color);
-                brush_color.setAlphaF(alpha);
-                painter.setBrush(brush_color);
-                painter.setPen(Qt::NoPen);
-                painter.drawEllipse(QPointF(x, y), r, r);
-            }
-            for (auto _line : debug_draw.value("Lines").toArray()) {
-                auto line = _line.toObject();
-                double prev_x;
-                double prev_y;
-                bool is_first = true;
-                auto color = line.value("C").toString("black");
-                auto alpha = line.value("A").toDouble(1.0);
-                QColor brush_color(color);
-                brush_color.setAlphaF(alpha);
-                painter.setPen(QPen(QBrush(brush_color), 1));
-                for (auto _point : line.value("P").toArray()) {
-                    auto point = _point.toObject();
-                    auto x = point.value("X").toDouble();
-                    auto y = point.value("Y").toDouble();
-                    if (!is_first) {
-                        painter.drawLine(QPointF(prev_x, prev_y), QPointF(x, y));
-                    }
-                    prev_x = x;
-                    prev_y = y;
-                    is_first = false;
-                }
-            }
-        }
-        if (!debug_message.isNull()) {
-            painter.setPen(QPen(QBrush(Qt::black), 1));
-            double x = 10;
-            double y = 15;
-            double dy = y;
-            for (auto message : debug_message.split("; ")) {
-                painter.drawText(x, y, message);
-                y += dy;
-            }
-        }
-    }
-
     bool update_vision(int frag_cnt) {
         double new_vision;
         if (frag_cnt == 1) {
             new_vision = radius * VIS_FACTOR;
         }
         else {
-            new_vision = radius * VIS_FACTOR_FR * qSqrt(frag_cnt);
+            new_vision = radius * VIS_FACTOR_FR * std::sqrt(frag_cnt);
         }
         if (vision_radius != new_vision) {
             vision_radius = new_vision;
@@ -176,35 +119,14 @@ public:
         return false;
     }
 
-    bool can_see(const Circle *circle) {
-        double xVisionCenter = x + qCos(angle) * VIS_SHIFT;
-        double yVisionCenter = y + qSin(angle) * VIS_SHIFT;
+    bool can_see(const Circle *circle) const {
+        double xVisionCenter = x + std::cos(angle) * VIS_SHIFT;
+        double yVisionCenter = y + std::sin(angle) * VIS_SHIFT;
         double qdist = circle->calc_qdist(xVisionCenter, yVisionCenter);
 
         return (qdist < (vision_radius + circle->getR()) * (vision_radius + circle->getR()));
     }
 
-    void draw_vision_ellipse(QPainter &painter) const {
-        double xVisionCenter = x + qCos(angle) * VIS_SHIFT;
-        double yVisionCenter = y + qSin(angle) * VIS_SHIFT;
-
-        painter.drawEllipse(QPointF(xVisionCenter, yVisionCenter), vision_radius, vision_radius);
-    }
-
-    void clear_vision_area(QPainter &painter) const {
-        painter.setPen(Qt::white);
-        painter.setBrush(Qt::white);
-
-        draw_vision_ellipse(painter);
-    }
-
-    void draw_vision_line(QPainter &painter) const {
-        painter.setPen(QPen(QBrush(Qt::black), 1, Qt::DashLine));
-        painter.setBrush(Qt::transparent);
-
-        draw_vision_ellipse(painter);
-     }
-
     double can_eat(Circle *food) const {
         if (food->is_player() && food->getId() == id) {
             return -INFINITY;
@@ -222,58 +144,59 @@ public:
         mass += food->getM();
     }
 
-    bool can_burst(int yet_cnt) {
+    bool can_burst(int yet_cnt, const GameConfig &config) {
         if (mass < MIN_BURST_MASS * 2) {
             return false;
         }
         int frags_cnt = int(mass / MIN_BURST_MASS);
-        if (frags_cnt > 1 && rest_fragments_count(yet_cnt) > 0) {
+        if (frags_cnt > 1 && rest_fragments_count(yet_cnt, config) > 0) {
             return true;
         }
         return false;
     }
 
-    void burst_on(Circle *virus) {
+    void burst_on(Circle *virus, const GameConfig &config) {
         double dy = y - virus->getY(), dx = x - virus->getX();
 
-        angle = qAtan2(dy, dx);
-        double max_speed = Constants::instance().SPEED_FACTOR / qSqrt(mass);
+        angle = std::atan2(dy, dx);
+        double max_speed = config.SPEED_FACTOR / std::sqrt(mass);
         if (speed < max_speed) {
             speed = max_speed;
         }
         mass += BURST_BONUS;
     }
 
-    QVector<Player*> burst_now(int max_fId, int yet_cnt) {
-        QVector<Player*> fragments;
+    // осколки складываются в fragments по значению; объекты под них выделяет механика
+    void burst_now(int max_fId, int yet_cnt, const GameConfig &config, std::vector<Player> &fragments) {
+        fragments.clear();
         int new_frags_cnt = int(mass / MIN_BURST_MASS) - 1;
 
-        new_frags_cnt = std::min(new_frags_cnt, rest_fragments_count(yet_cnt));
+        new_frags_cnt = std::min(new_frags_cnt, rest_fragments_count(yet_cnt, config));
 
         double new_mass = mass / (new_frags_cnt + 1);
         double new_radius = mass2radius(new_mass);
 
         for (int I = 0; I < new_frags_cnt; I++) {
             int new_fId = max_fId + I + 1;
-            Player *new_fragment = new Player(id, x, y, new_radius, new_mass, new_fId);
-            new_fragment->set_color(color);
-            fragments.append(new_fragment);
+            fragments.push_back(Player(id, x, y, new_radius, new_mass, new_fId));
+            Player &new_fragment = fragments.back();
+            new_fragment.set_color(color);
+            new_fragment.fuse_timer = config.TICKS_TIL_FUSION;
 
             double burst_angle = angle - BURST_ANGLE_SPECTRUM / 2 + I * BURST_ANGLE_SPECTRUM / new_frags_cnt;
-            new_fragment->set_impulse(BURST_START_SPEED, burst_angle);
+            new_fragment.set_impulse(BURST_START_SPEED, burst_angle);
         }
         set_impulse(BURST_START_SPEED, angle + BURST_ANGLE_SPECTRUM / 2);
 
         fragmentId = max_fId + new_frags_cnt + 1;
         mass = new_mass;
         radius = new_radius;
-        fuse_timer = Constants::instance().TICKS_TIL_FUSION;
-        return fragments;
+        fuse_timer = config.TICKS_TIL_FUSION;
     }
 
-    bool can_split(int yet_cnt) {
+    bool can_split(int yet_cnt, const GameConfig &config) {
 
-        if (rest_fragments_count(yet_cnt) > 0) {
+        if (rest_fragments_count(yet_cnt, config) > 0) {
 
             if (mass > MIN_SPLIT_MASS) {
                 return true;
@@ -282,16 +205,17 @@ public:
         return false;
     }
 
-    Player *split_now(int max_fId) {
+    Player split_now(int max_fId, const GameConfig &config) {
         double new_mass = mass / 2;
         double new_radius = mass2radius(new_mass);
 
-        Player *new_player = new Player(id, x, y, new_radius, new_mass, max_fId + 1);
-        new_player->set_color(color);
-        new_player->set_impulse(SPLIT_START_SPEED, angle);
+        Player new_player(id, x, y, new_radius, new_mass, max_fId + 1);
+        new_player.set_color(color);
+        new_player.set_impulse(SPLIT_START_SPEED, angle);
+        new_player.fuse_timer = config.TICKS_TIL_FUSION;
 
         fragmentId = max_fId + 2;
-        fuse_timer = Constants::instance().TICKS_TIL_FUSION;
+        fuse_timer = config.TICKS_TIL_FUSION;
         mass = new_mass;
         radius = new_radius;
 
@@ -318,7 +242,7 @@ public:
         double collisionVectorX = this->x - other->x;
         double collisionVectorY = this->y - other->y;
         // normalize to 1
-        double vectorLen = qSqrt(collisionVectorX * collisionVectorX + collisionVectorY * collisionVectorY);
+        double vectorLen = std::sqrt(collisionVectorX * collisionVectorX + collisionVectorY * collisionVectorY);
         if (vectorLen < 1e-9) { // collision object in same point??
             return;
         }
@@ -334,32 +258,32 @@ public:
         {
             double currPart = other->getM() / sumMass; // more influence on us if other bigger and vice versa
 
-            double dx = speed * qCos(angle);
-            double dy = speed * qSin(angle);
+            double dx = speed * std::cos(angle);
+            double dy = speed * std::sin(angle);
             dx += collisionForce * currPart * collisionVectorX;
             dy += collisionForce * currPart * collisionVectorY;
-            this->speed = qSqrt(dx * dx + dy * dy);
-            this->angle = qAtan2(dy, dx);
+            this->speed = std::sqrt(dx * dx + dy * dy);
+            this->angle = std::atan2(dy, dx);
         }
 
         // calc influence on other
         {
             double otherPart = getM() / sumMass;
 
-            double dx = other->speed * qCos(other->angle);
-            double dy = other->speed * qSin(other->angle);
+            double dx = other->speed * std::cos(other->angle);
+            double dy = other->speed * std::sin(other->angle);
             dx -= collisionForce * otherPart * collisionVectorX;
             dy -= collisionForce * otherPart * collisionVectorY;
-            other->speed = qSqrt(dx * dx + dy * dy);
-            other->angle = qAtan2(dy, dx);
+            other->speed = std::sqrt(dx * dx + dy * dy);
+            other->angle = std::atan2(dy, dx);
         }
     }
 
     void fusion(Player *frag) {
-        double fragDX = frag->speed * qCos(frag->angle);
-        double fragDY = frag->speed * qSin(frag->angle);
-        double dX = speed * qCos(angle);
-        double dY = speed * qSin(angle);
+        double fragDX = frag->speed * std::cos(frag->angle);
+        double fragDY = frag->speed * std::sin(frag->angle);
+        double dX = speed * std::cos(angle);
+        double dY = speed * std::sin(angle);
         double sumMass = mass + frag->mass;
 
         double fragInfluence = frag->mass / sumMass;
@@ -374,8 +298,8 @@ public:
         dY = dY * currInfluence + fragDY * fragInfluence;
 
         // new angle and speed, based on vectors
-        angle = qAtan2(dY, dX);
-        speed = qSqrt(dX * dX + dY * dY);
+        angle = std::atan2(dY, dX);
+        speed = std::sqrt(dX * dX + dY * dY);
 
         mass += frag->getM();
     }
@@ -384,19 +308,20 @@ public:
         return mass > MIN_EJECT_MASS;
     }
 
-    Ejection *eject_now(int eject_id) {
-        double ex = x + qCos(angle) * (radius + 1);
-        double ey = y + qSin(angle) * (radius + 1);
+    Ejection eject_now(int eject_id) {
+        double ex = x + std::cos(angle) * (radius + 1);
+        double ey = y + std::sin(angle) * (radius + 1);
 
-        Ejection *new_eject = new Ejection(eject_id, ex, ey, EJECT_RADIUS, EJECT_MASS, this->id);
-        new_eject->set_impulse(EJECT_START_SPEED, angle);
+        Ejection new_eject(eject_id, ex, ey, EJECT_RADIUS, EJECT_MASS, this->id);
+        new_eject.set_impulse(EJECT_START_SPEED, angle);
 
         mass -= EJECT_MASS;
         radius = mass2radius(mass);
         return new_eject;
     }
 
-    bool update_by_mass(int max_x, int max_y) {
+    bool update_by_mass(const GameConfig &config) {
+        const int max_x = config.GAME_WIDTH, max_y = config.GAME_HEIGHT;
         bool changed = false;
         double new_radius = mass2radius(mass);
         if (radius != new_radius) {
@@ -404,7 +329,7 @@ public:
             changed = true;
         }
 
-        double new_speed = Constants::instance().SPEED_FACTOR / qSqrt(mass);
+        double new_speed = config.SPEED_FACTOR / std::sqrt(mass);
         if (speed > new_speed && !is_fast) {
             speed = new_speed;
         }
@@ -429,39 +354,42 @@ public:
         return changed;
     }
 
-    void apply_direct(Direct direct, int max_x, int max_y) {
-        direct.limit();
+    template <typename Config>
+    void apply_direct(Direct direct, const Config &config) {
+        direct.limit(config);
         cmd_x = direct.x; cmd_y = direct.y;
         if (is_fast) return;
 
-        double speed_x = speed * qCos(angle);
-        double speed_y = speed * qSin(angle);
-        double max_speed = Constants::instance().SPEED_FACTOR / qSqrt(mass);
+        double speed_x = speed * std::cos(angle);
+        double speed_y = speed * std::sin(angle);
+        double max_speed = config.SPEED_FACTOR / std::sqrt(mass);
 
         double dy = direct.y - y, dx = direct.x - x;
-        double dist = qSqrt(dx * dx + dy * dy);
+        double dist = std::sqrt(dx * dx + dy * dy);
         double ny = (dist > 0)? (dy / dist) : 0;
         double nx = (dist > 0)? (dx / dist) : 0;
-        double inertion = Constants::instance().INERTION_FACTOR;
+        double inertion = config.INERTION_FACTOR;
 
         speed_x += (nx * max_speed - speed_x) * inertion / mass;
         speed_y += (ny * max_speed - speed_y) * inertion / mass;
 
-        angle = qAtan2(speed_y, speed_x);
+        angle = std::atan2(speed_y, speed_x);
 
-        double new_speed = qSqrt(speed_x*speed_x + speed_y*speed_y);
+        double new_speed = std::sqrt(speed_x*speed_x + speed_y*speed_y);
         if (new_speed > max_speed) {
             new_speed = max_speed;
         }
         speed = new_speed;
     }
 
-    bool move(int max_x, int max_y) {
+    template <typename Config>
+    bool move(const Config &config) {
+        const int max_x = config.GAME_WIDTH, max_y = config.GAME_HEIGHT;
         double rB = x + radius, lB = x - radius;
         double dB = y + radius, uB = y - radius;
 
-        double dx = speed * qCos(angle);
-        double dy = speed * qSin(angle);
+        double dx = speed * std::cos(angle);
+        double dy = speed * std::sin(angle);
 
         bool changed = false;
         if (rB + dx < max_x && lB + dx > 0) {
@@ -470,12 +398,12 @@ public:
         }
         else {
             // долетаем до стенки
-            double new_x = qMax(radius, qMin(max_x - radius, x + dx));
+            double new_x = std::max(radius, std::min(max_x - radius, x + dx));
             changed |= (x != new_x);
             x = new_x;
             // зануляем проекцию скорости по dx
-            double speed_y = speed * qSin(angle);
-            speed = qAbs(speed_y);
+            double speed_y = speed * std::sin(angle);
+            speed = abs_value(speed_y);
             angle = (speed_y >= 0)? M_PI / 2 : -M_PI / 2;
         }
         if (dB + dy < max_y && uB + dy > 0) {
@@ -484,18 +412,18 @@ public:
         }
         else {
             // долетаем до стенки
-            double new_y = qMax(radius, qMin(max_y - radius, y + dy));
+            double new_y = std::max(radius, std::min(max_y - radius, y + dy));
             changed |= (y != new_y);
             y = new_y;
             // зануляем проекцию скорости по dy
-            double speed_x = speed * qCos(angle);
-            speed = qAbs(speed_x);
+            double speed_x = speed * std::cos(angle);
+            speed = abs_value(speed_x);
             angle = (speed_x >= 0)? 0 : M_PI;
         }
 
         if (is_fast) {
-            double max_speed = Constants::instance().SPEED_FACTOR / qSqrt(mass);
-            apply_viscosity(max_speed);
+            double max_speed = config.SPEED_FACTOR / std::sqrt(mass);
+            apply_viscosity(max_speed, config);
         }
         if (fuse_timer > 0) {
             fuse_timer--;
@@ -519,30 +447,10 @@ public:
         mass -= ((mass - MIN_SHRINK_MASS) * SHRINK_FACTOR);
         radius = mass2radius(mass);
     }
-    double get_speed() {
+    double get_speed() const {
         return speed;
     }
 public:
-    virtual QJsonObject toJson(bool mine=false) const {
-        QJsonObject objData;
-        objData.insert("Id", QJsonValue(id_to_str()));
-        objData.insert("X", QJsonValue(x));
-        objData.insert("Y", QJsonValue(y));
-        objData.insert("M", QJsonValue(mass));
-        objData.insert("R", QJsonValue(radius));
-        if (mine) {
-            objData.insert("SX", QJsonValue(speed * qCos(angle)));
-            objData.insert("SY", QJsonValue(speed * qSin(angle)));
-            if (fuse_timer > 0) {
-                objData.insert("TTF", QJsonValue(fuse_timer));
-            }
-        }
-        else {
-            objData.insert("T", QJsonValue("P"));
-        }
-        return objData;
-    }
-
     static double mass2radius(double mass) {
         return PLAYER_RADIUS_FACTOR * std::sqrt(mass);
     }
@@ -552,11 +460,11 @@ private:
      * @return максимально возможное число фрагментов, которое может дополнительно появиться у игрока в результате
      * взрыва / деления
      */
-    static int rest_fragments_count(const int existingFragmentsCount) {
-        return Constants::instance().MAX_FRAGS_CNT - existingFragmentsCount;
+    static int rest_fragments_count(const int existingFragmentsCount, const GameConfig &config) {
+        return config.MAX_FRAGS_CNT - existingFragmentsCount;
     }
 };
 
-typedef QVector<Player*> PlayerArray;
+typedef std::vector<Player*> PlayerArray;
 
 #endif // PLAYER_H
@@ -0,0 +1,86 @@
+#ifndef VIRUS_H
+#define VIRUS_H
+
+#include "circle.h"
+#include "ejection.h"
+
+
+class Virus : public Circle
+{
+protected:
+    double speed;
+    double angle, split_angle;
+
+public:
+    explicit Virus(int _id, double _x, double _y, double _radius, double _mass) :
+        Circle(_id, _x, _y, _radius, _mass),
+        speed(0.0),
+        angle(0.0),
+        split_angle(0.0)
+    {}
+
+    virtual ~Virus() {}
+
+    virtual bool is_virus() const {
+        return true;
+    }
+
+    double can_hurt(Circle *circle) const {
+        if (circle->getR() < radius) {
+            return INFINITY;
+        }
+        double qdist = circle->calc_qdist(x, y);
+        double tR = radius * RAD_HURT_FACTOR + circle->getR();
+        if (qdist < tR * tR) {
+            return qdist;
+        }
+        return INFINITY;
+    }
+
+    double can_eat(Ejection *eject) {
+        if (mass > eject->getM() * MASS_EAT_FACTOR) { // eat ejection
+            double dist = eject->calc_dist(x, y);
+            if (dist - eject->getR() + (eject->getR() * 2) * DIAM_EAT_FACTOR < radius) {
+                return radius - dist;
+            }
+        }
+        return -INFINITY;
+    }
+
+    void eat(Ejection *eject) {
+        mass += eject->getM();
+        split_angle = eject->getA();
+    }
+
+    bool can_split(const GameConfig &config) {
+        return mass > config.VIRUS_SPLIT_MASS;
+    }
+
+    Virus split_now(int new_id, const GameConfig &config) {
+        double new_speed = VIRUS_SPLIT_SPEED, new_angle = split_angle;
+
+        Virus new_virus(new_id, x, y, config.VIRUS_RADIUS, VIRUS_MASS);
+        new_virus.set_impulse(new_speed, new_angle);
+
+        mass = VIRUS_MASS;
+        return new_virus;
+    }
+
+public:
+    void set_impulse(double _speed, double _angle) {
+        speed = abs_value(_speed);
+        angle = _angle;
+    }
+
+    double get_speed() const {
+        return speed;
+    }
+
+    double get_angle() const {
+        return angle;
+    }
+};
+
+typedef std::vector<Virus*> VirusArray;
+
+#endif // VIRUS_H
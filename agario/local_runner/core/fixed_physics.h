@@ -0,0 +1,55 @@
+#ifndef FIXED_PHYSICS_H
+#define FIXED_PHYSICS_H
+
+#include "constants.h"
+
+
+// Наборы параметров физики, для которых при сборке с FIXED_PHYSICS
+// (qmake CONFIG+=fixed_physics) компилируются отдельные ядра движения:
+// параметры в них - константы времени компиляции, а не поля GameConfig.
+// Набор выбирается при создании Mechanic, если параметры игры совпадают
+// с ним точно; иначе игра идёт на общем ядре с тем же результатом.
+//
+//   name, GAME_WIDTH, GAME_HEIGHT, INERTION_FACTOR, VISCOSITY, SPEED_FACTOR
+#define FIXED_PHYSICS_TABLE(X)                                                 \
+    X(Defaults, 990, 990, 10.0, 0.25, 25.0)
+
+#define DECLARE_FIXED_PHYSICS(NAME, WIDTH, HEIGHT, INERTION, VISC, SPEED)      \
+    struct FixedPhysics##NAME {                                                \
+        static constexpr int GAME_WIDTH = WIDTH;                               \
+        static constexpr int GAME_HEIGHT = HEIGHT;                             \
+        static constexpr double INERTION_FACTOR = INERTION;                    \
+        static constexpr double VISCOSITY = VISC;                              \
+        static constexpr double SPEED_FACTOR = SPEED;                          \
+    };
+
+FIXED_PHYSICS_TABLE(DECLARE_FIXED_PHYSICS)
+#undef DECLARE_FIXED_PHYSICS
+
+#define FIXED_PHYSICS_ID(NAME, ...) FIXED_PHYSICS_##NAME,
+enum FixedPhysicsId {
+    NO_FIXED_PHYSICS = -1,
+    FIXED_PHYSICS_TABLE(FIXED_PHYSICS_ID)
+};
+#undef FIXED_PHYSICS_ID
+
+// набор из таблицы, совпадающий с параметрами игры, или NO_FIXED_PHYSICS
+inline FixedPhysicsId find_fixed_physics(const GameConfig &config) {
+#ifdef FIXED_PHYSICS
+#define MATCH_FIXED_PHYSICS(NAME, ...)                                         \
+    if (config.GAME_WIDTH == FixedPhysics##NAME::GAME_WIDTH &&                 \
+        config.GAME_HEIGHT == FixedPhysics##NAME::GAME_HEIGHT &&               \
+        config.INERTION_FACTOR == FixedPhysics##NAME::INERTION_FACTOR &&       \
+        config.VISCOSITY == FixedPhysics##NAME::VISCOSITY &&                   \
+        config.SPEED_FACTOR == FixedPhysics##NAME::SPEED_FACTOR) {             \
+        return FIXED_PHYSICS_##NAME;                                           \
+    }
+    FIXED_PHYSICS_TABLE(MATCH_FIXED_PHYSICS)
+#undef MATCH_FIXED_PHYSICS
+#else
+    (void)config;
+#endif
+    return NO_FIXED_PHYSICS;
+}
+
+#endif // FIXED_PHYSICS_H
@@ -0,0 +1,331 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include "json_writer.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+
+// Разбор ответов стратегий без Qt (для сервера на epoll). Значения ведут себя
+// как QJsonValue: to_double/to_bool/to_string возвращают значение по
+// умолчанию, если тип не тот. Ключи объекта хранятся по алфавиту, при
+// повторе ключа остаётся последнее значение.
+struct JsonValue
+{
+    enum Type {
+        JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT
+    };
+
+    Type type;
+    bool boolean;
+    double number;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    JsonValue() : type(JSON_NULL), boolean(false), number(0) {}
+
+    bool is_object() const {
+        return type == JSON_OBJECT;
+    }
+
+    bool contains(const std::string &key) const {
+        return object.find(key) != object.end();
+    }
+
+    // пустое значение, если ключа нет
+    const JsonValue &value(const std::string &key) const {
+        static const JsonValue empty;
+        auto it = object.find(key);
+        return it == object.end()? empty : it->second;
+    }
+
+    double to_double(double def=0) const {
+        return type == JSON_NUMBER? number : def;
+    }
+
+    bool to_bool(bool def=false) const {
+        return type == JSON_BOOL? boolean : def;
+    }
+
+    std::string to_string(const std::string &def="") const {
+        return type == JSON_STRING? string : def;
+    }
+};
+
+
+class JsonReader
+{
+private:
+    const char *p, *end;
+    std::string error;
+
+    void skip_spaces() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+    }
+
+    bool fail(const char *message) {
+        if (error.empty()) {
+            error = message;
+        }
+        return false;
+    }
+
+    bool literal(const char *word) {
+        for (; *word; word++, p++) {
+            if (p >= end || *p != *word) {
+                return fail("illegal value");
+            }
+        }
+        return true;
+    }
+
+    static void append_utf8(std::string &out, unsigned code) {
+        if (code < 0x80) {
+            out += char(code);
+        } else if (code < 0x800) {
+            out += char(0xC0 | code >> 6);
+            out += char(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += char(0xE0 | code >> 12);
+            out += char(0x80 | (code >> 6 & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+        } else {
+            out += char(0xF0 | code >> 18);
+            out += char(0x80 | (code >> 12 & 0x3F));
+            out += char(0x80 | (code >> 6 & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parse_hex(unsigned &code) {
+        if (end - p < 4) {
+            return fail("invalid escape sequence");
+        }
+        code = 0;
+        for (int I = 0; I < 4; I++, p++) {
+            char c = *p;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return fail("invalid escape sequence");
+        }
+        return true;
+    }
+
+    bool parse_string(std::string &out) {
+        p++;    // "
+        out.clear();
+        while (p < end && *p != '"') {
+            if ((unsigned char)*p < 0x20) {
+                return fail("illegal value");
+            }
+            if (*p != '\\') {
+                out += *p++;
+                continue;
+            }
+            if (++p >= end) {
+                break;
+            }
+            char c = *p++;
+            switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned code;
+                if (! parse_hex(code)) {
+                    return false;
+                }
+                if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    p += 2;
+                    unsigned low;
+                    if (! parse_hex(low)) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return fail("invalid escape sequence");
+            }
+        }
+        if (p >= end) {
+            return fail("unterminated string");
+        }
+        p++;
+        return true;
+    }
+
+    bool parse_number(JsonValue &value) {
+        std::string text;
+        while (p < end && (std::isdigit((unsigned char)*p) || *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E')) {
+            text += *p++;
+        }
+        char *stop;
+        value.number = std::strtod(text.c_str(), &stop);
+        if (text.empty() || *stop != '\0') {
+            return fail("illegal number");
+        }
+        value.type = JsonValue::JSON_NUMBER;
+        return true;
+    }
+
+    bool parse_value(JsonValue &value, int depth) {
+        if (depth > 64) {
+            return fail("too deeply nested document");
+        }
+        skip_spaces();
+        if (p >= end) {
+            return fail("unterminated object");
+        }
+        switch (*p) {
+        case '{': {
+            p++;
+            value.type = JsonValue::JSON_OBJECT;
+            skip_spaces();
+            if (p < end && *p == '}') {
+                p++;
+                return true;
+            }
+            while (true) {
+                skip_spaces();
+                if (p >= end || *p != '"') {
+                    return fail("missing name separator");
+                }
+                std::string key;
+                if (! parse_string(key)) {
+                    return false;
+                }
+                skip_spaces();
+                if (p >= end || *p != ':') {
+                    return fail("missing name separator");
+                }
+                p++;
+                JsonValue item;
+                if (! parse_value(item, depth + 1)) {
+                    return false;
+                }
+                value.object[key] = item;
+                skip_spaces();
+                if (p < end && *p == ',') {
+                    p++;
+                } else if (p < end && *p == '}') {
+                    p++;
+                    return true;
+                } else {
+                    return fail("unterminated object");
+                }
+            }
+        }
+        case '[': {
+            p++;
+            value.type = JsonValue::JSON_ARRAY;
+            skip_spaces();
+            if (p < end && *p == ']') {
+                p++;
+                return true;
+            }
+            while (true) {
+                value.array.push_back(JsonValue());
+                if (! parse_value(value.array.back(), depth + 1)) {
+                    return false;
+                }
+                skip_spaces();
+                if (p < end && *p == ',') {
+                    p++;
+                } else if (p < end && *p == ']') {
+                    p++;
+                    return true;
+                } else {
+                    return fail("unterminated array");
+                }
+            }
+        }
+        case '"':
+            value.type = JsonValue::JSON_STRING;
+            return parse_string(value.string);
+        case 't':
+            value.type = JsonValue::JSON_BOOL;
+            value.boolean = true;
+            return literal("true");
+        case 'f':
+            value.type = JsonValue::JSON_BOOL;
+            return literal("false");
+        case 'n':
+            return literal("null");
+        default:
+            return parse_number(value);
+        }
+    }
+
+public:
+    JsonReader(const char *data, size_t size) :
+        p(data),
+        end(data + size)
+    {}
+
+    // false - не JSON; текст ошибки в get_error()
+    bool parse(JsonValue &value) {
+        value = JsonValue();
+        if (! parse_value(value, 0)) {
+            return false;
+        }
+        skip_spaces();
+        if (p != end) {
+            return fail("garbage at the end of the document");
+        }
+        return true;
+    }
+
+    const std::string &get_error() const {
+        return error;
+    }
+
+    // как QJsonDocument::Compact
+    static void write(std::string &out, const JsonValue &value) {
+        switch (value.type) {
+        case JsonValue::JSON_NULL: out += "null"; break;
+        case JsonValue::JSON_BOOL: out += value.boolean? "true" : "false"; break;
+        case JsonValue::JSON_NUMBER: JsonWriter::append_number(out, value.number); break;
+        case JsonValue::JSON_STRING: JsonWriter::append_string(out, value.string); break;
+        case JsonValue::JSON_ARRAY:
+            out += '[';
+            for (size_t I = 0; I < value.array.size(); I++) {
+                if (I > 0) out += ',';
+                write(out, value.array[I]);
+            }
+            out += ']';
+            break;
+        case JsonValue::JSON_OBJECT: {
+            out += '{';
+            bool first = true;
+            for (const auto &item : value.object) {
+                if (! first) out += ',';
+                first = false;
+                JsonWriter::append_string(out, item.first);
+                out += ':';
+                write(out, item.second);
+            }
+            out += '}';
+            break;
+        }
+        }
+    }
+};
+
+#endif // JSON_READER_H
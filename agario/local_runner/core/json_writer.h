@@ -0,0 +1,360 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "entities/food.h"
+#include "entities/virus.h"
+#include "entities/player.h"
+#include "entities/ejection.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+
+// Сообщения протокола стратегий без Qt. Вывод повторяет QJsonDocument::Compact:
+// ключи объекта по алфавиту, числа в кратчайшей точной записи.
+class JsonWriter
+{
+public:
+    static void append_number(std::string &out, double value) {
+        if (! std::isfinite(value)) {
+            out += "null";
+            return;
+        }
+        char buffer[32];
+        for (int precision = 15; precision <= 17; precision++) {
+            std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            if (std::strtod(buffer, NULL) == value) {
+                break;
+            }
+        }
+        out += buffer;
+    }
+
+    static void append_string(std::string &out, const std::string &value) {
+        out += '"';
+        for (char c : value) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    static void append_key(std::string &out, const char *key, bool first=false) {
+        if (! first) {
+            out += ',';
+        }
+        out += '"';
+        out += key;
+        out += "\":";
+    }
+
+public:
+    // Объекты по значениям полей: так же собирается дамп из кадра двоичного
+    // протокола (WireReader::read_state_json).
+    // у еды в полном состоянии нет Id; разностный протокол ссылается на неё по номеру
+    static void append_food(std::string &out, int id, double x, double y, bool with_id=false) {
+        out += '{';
+        if (with_id) {
+            append_key(out, "Id", true); append_string(out, std::to_string(id));
+        }
+        append_key(out, "T", ! with_id); out += "\"F\"";
+        append_key(out, "X"); append_number(out, x);
+        append_key(out, "Y"); append_number(out, y);
+        out += '}';
+    }
+
+    static void append_eject(std::string &out, int id, double x, double y, int player) {
+        out += '{';
+        append_key(out, "Id", true); append_string(out, std::to_string(id));
+        append_key(out, "T"); out += "\"E\"";
+        append_key(out, "X"); append_number(out, x);
+        append_key(out, "Y"); append_number(out, y);
+        append_key(out, "pId"); append_number(out, player);
+        out += '}';
+    }
+
+    static void append_virus(std::string &out, int id, double m, double x, double y) {
+        out += '{';
+        append_key(out, "Id", true); append_string(out, std::to_string(id));
+        append_key(out, "M"); append_number(out, m);
+        append_key(out, "T"); out += "\"V\"";
+        append_key(out, "X"); append_number(out, x);
+        append_key(out, "Y"); append_number(out, y);
+        out += '}';
+    }
+
+    // чужой фрагмент
+    static void append_player(std::string &out, const std::string &id, double m, double r, double x, double y) {
+        out += '{';
+        append_key(out, "Id", true); append_string(out, id);
+        append_key(out, "M"); append_number(out, m);
+        append_key(out, "R"); append_number(out, r);
+        append_key(out, "T"); out += "\"P\"";
+        append_key(out, "X"); append_number(out, x);
+        append_key(out, "Y"); append_number(out, y);
+        out += '}';
+    }
+
+    // свой фрагмент: со скоростью и временем до слияния
+    static void append_fragment(std::string &out, const std::string &id, double m, double r,
+                                double sx, double sy, int ttf, double x, double y) {
+        out += '{';
+        append_key(out, "Id", true); append_string(out, id);
+        append_key(out, "M"); append_number(out, m);
+        append_key(out, "R"); append_number(out, r);
+        append_key(out, "SX"); append_number(out, sx);
+        append_key(out, "SY"); append_number(out, sy);
+        if (ttf > 0) {
+            append_key(out, "TTF"); append_number(out, ttf);
+        }
+        append_key(out, "X"); append_number(out, x);
+        append_key(out, "Y"); append_number(out, y);
+        out += '}';
+    }
+
+    static void append(std::string &out, const Food *food, bool with_id=false) {
+        append_food(out, food->getId(), food->getX(), food->getY(), with_id);
+    }
+
+    static void append(std::string &out, const Ejection *eject) {
+        append_eject(out, eject->getId(), eject->getX(), eject->getY(), eject->get_player());
+    }
+
+    static void append(std::string &out, const Virus *virus) {
+        append_virus(out, virus->getId(), virus->getM(), virus->getX(), virus->getY());
+    }
+
+    static void append(std::string &out, const Player *player, bool mine=false) {
+        if (mine) {
+            append_fragment(out, player->id_to_str(), player->getM(), player->getR(),
+                            player->get_speed() * std::cos(player->getA()),
+                            player->get_speed() * std::sin(player->getA()),
+                            player->fuse_timer, player->getX(), player->getY());
+        } else {
+            append_player(out, player->id_to_str(), player->getM(), player->getR(), player->getX(), player->getY());
+        }
+    }
+
+    static void append(std::string &out, const Circle *circle, bool food_id=false) {
+        if (circle->is_player()) {
+            append(out, static_cast<const Player*>(circle));
+        } else if (circle->is_virus()) {
+            append(out, static_cast<const Virus*>(circle));
+        } else if (circle->is_ejection()) {
+            append(out, static_cast<const Ejection*>(circle));
+        } else {
+            append(out, static_cast<const Food*>(circle), food_id);
+        }
+    }
+
+public:
+    // {"Mine":[...],"Objects":[...]} с переводом строки в конце
+    static void write_state(std::string &out, const PlayerArray &fragments, const CircleArray &visibles) {
+        out.clear();
+        out += "{\"Mine\":[";
+        for (size_t I = 0; I < fragments.size(); I++) {
+            if (I > 0) out += ',';
+            append(out, fragments[I], true);
+        }
+        out += "],\"Objects\":[";
+        for (size_t I = 0; I < visibles.size(); I++) {
+            if (I > 0) out += ',';
+            append(out, visibles[I]);
+        }
+        out += "]}\n";
+    }
+
+    static void write_config(std::string &out, const GameConfig &config) {
+        out.clear();
+        out += '{';
+        append_key(out, "FOOD_MASS", true); append_number(out, config.FOOD_MASS);
+        append_key(out, "GAME_HEIGHT"); append_number(out, config.GAME_HEIGHT);
+        append_key(out, "GAME_TICKS"); append_number(out, config.GAME_TICKS);
+        append_key(out, "GAME_WIDTH"); append_number(out, config.GAME_WIDTH);
+        append_key(out, "INERTION_FACTOR"); append_number(out, config.INERTION_FACTOR);
+        append_key(out, "MAX_FRAGS_CNT"); append_number(out, config.MAX_FRAGS_CNT);
+        append_key(out, "SPEED_FACTOR"); append_number(out, config.SPEED_FACTOR);
+        append_key(out, "TICKS_TIL_FUSION"); append_number(out, config.TICKS_TIL_FUSION);
+        append_key(out, "VIRUS_RADIUS"); append_number(out, config.VIRUS_RADIUS);
+        append_key(out, "VIRUS_SPLIT_MASS"); append_number(out, config.VIRUS_SPLIT_MASS);
+        append_key(out, "VISCOSITY"); append_number(out, config.VISCOSITY);
+        out += "}\n";
+    }
+};
+
+
+// Объекты тика в JSON, общие для всех сообщений состояния этого тика: еду и
+// вирусы обычно видят несколько игроков, а сериализуется каждый объект один
+// раз. Сообщение собирается из готовых кусков и совпадает с write_state.
+// clear() - в начале каждого тика: ключ - адрес объекта, а объекты между
+// тиками двигаются и пересоздаются.
+class JsonObjectCache
+{
+private:
+    typedef std::pair<size_t, size_t> Slice;
+
+    std::string buffer;
+    // [0] - как в полном состоянии, [1] - еда с Id (разностный протокол)
+    std::unordered_map<const Circle*, Slice> slices[2];
+
+public:
+    void clear() {
+        buffer.clear();
+        slices[0].clear();
+        slices[1].clear();
+    }
+
+    // JSON объекта: [first, first + second) в data(); сдвиги, а не указатели,
+    // потому что буфер растёт
+    Slice slice(const Circle *circle, bool food_id=false) {
+        std::unordered_map<const Circle*, Slice> &kind = slices[food_id && circle->is_food()? 1 : 0];
+        auto it = kind.find(circle);
+        if (it == kind.end()) {
+            size_t start = buffer.size();
+            JsonWriter::append(buffer, circle, food_id);
+            it = kind.insert(std::make_pair(circle, Slice(start, buffer.size() - start))).first;
+        }
+        return it->second;
+    }
+
+    const std::string &data() const {
+        return buffer;
+    }
+
+    void append(std::string &out, const Circle *circle, bool food_id=false) {
+        Slice part = slice(circle, food_id);
+        out.append(buffer, part.first, part.second);
+    }
+
+    // как JsonWriter::write_state; свои фрагменты видит один игрок, их не кешируем
+    void write_state(std::string &out, const PlayerArray &fragments, const CircleArray &visibles) {
+        out.clear();
+        out += "{\"Mine\":[";
+        for (size_t I = 0; I < fragments.size(); I++) {
+            if (I > 0) out += ',';
+            JsonWriter::append(out, fragments[I], true);
+        }
+        out += "],\"Objects\":[";
+        for (size_t I = 0; I < visibles.size(); I++) {
+            if (I > 0) out += ',';
+            append(out, visibles[I]);
+        }
+        out += "]}\n";
+    }
+};
+
+
+// Разностный протокол (клиент просит его в первом сообщении: "protocol":
+// "delta"). Сервер помнит, какие объекты и в каком виде клиент видел в
+// прошлом сообщении, и шлёт только новые и изменившиеся объекты, а в
+// "Removed" - номера пропавших из вида. Свои фрагменты шлются всегда целиком.
+// Каждое full_every-е сообщение - полный кадр с "Full":true: в нём все
+// видимые объекты, и клиент заменяет ими свой вид целиком. У всех объектов,
+// включая еду, есть "Id".
+//
+//   {"Full":true,"Mine":[...],"Objects":[...]}
+//   {"Mine":[...],"Objects":[...],"Removed":["57","2.1"]}
+class JsonDeltaState
+{
+private:
+    struct Seen {
+        std::string json;
+        unsigned stamp;
+    };
+
+    int full_every;
+    int frames;
+    unsigned stamp;
+    std::unordered_map<unsigned long long, Seen> view;
+
+    // номер объекта в виде; у игрока - номер и номер фрагмента
+    static unsigned long long key_of(const Circle *circle) {
+        unsigned long long key = (unsigned long long)(unsigned)circle->getId() << 24;
+        if (circle->is_player()) {
+            key |= 1ULL << 56 | (unsigned)static_cast<const Player*>(circle)->get_fId();
+        }
+        return key;
+    }
+
+    static void append_key_id(std::string &out, unsigned long long key) {
+        out += '"';
+        out += std::to_string((unsigned)(key >> 24));
+        if ((key >> 56) != 0 && (key & 0xFFFFFF) != 0) {
+            out += '.';
+            out += std::to_string((unsigned)(key & 0xFFFFFF));
+        }
+        out += '"';
+    }
+
+public:
+    explicit JsonDeltaState(int _full_every) :
+        full_every(_full_every > 0? _full_every : 1),
+        frames(0),
+        stamp(0)
+    {}
+
+    void write_state(std::string &out, const PlayerArray &fragments, const CircleArray &visibles, JsonObjectCache &cache) {
+        bool full = frames++ % full_every == 0;
+        if (full) {
+            view.clear();
+        }
+        stamp++;
+
+        out.clear();
+        out += full? "{\"Full\":true,\"Mine\":[" : "{\"Mine\":[";
+        for (size_t I = 0; I < fragments.size(); I++) {
+            if (I > 0) out += ',';
+            JsonWriter::append(out, fragments[I], true);
+        }
+        out += "],\"Objects\":[";
+        bool first = true;
+        for (Circle *circle : visibles) {
+            std::pair<size_t, size_t> part = cache.slice(circle, true);
+            Seen &seen = view[key_of(circle)];
+            seen.stamp = stamp;
+            if (! full && seen.json.compare(0, std::string::npos, cache.data(), part.first, part.second) == 0) {
+                continue;
+            }
+            seen.json.assign(cache.data(), part.first, part.second);
+            if (! first) out += ',';
+            first = false;
+            out += seen.json;
+        }
+        out += ']';
+        if (! full) {
+            out += ",\"Removed\":[";
+            first = true;
+            for (auto it = view.begin(); it != view.end(); ) {
+                if (it->second.stamp == stamp) {
+                    ++it;
+                    continue;
+                }
+                if (! first) out += ',';
+                first = false;
+                append_key_id(out, it->first);
+                it = view.erase(it);
+            }
+            out += ']';
+        }
+        out += "}\n";
+    }
+};
+
+#endif // JSON_WRITER_H
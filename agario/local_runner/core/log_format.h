@@ -0,0 +1,249 @@
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+
+// Форматирование строк лога прямо в накопительный буфер, без промежуточных
+// строк и выделений памяти. Числа пишутся ровно как printf("%.16g") (как
+// QString::number(num, 'g', 16)), так что лог побайтно прежний.
+
+// достаточный размер буфера для write_number
+#define NUMBER_BUFFER_SIZE 32
+
+inline int write_unsigned(char *out, unsigned long long value) {
+    char digits[24];
+    int len = 0;
+    do {
+        digits[len++] = char('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    for (int I = 0; I < len; I++) {
+        out[I] = digits[len - 1 - I];
+    }
+    return len;
+}
+
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 uint128;
+
+constexpr uint128 pow10_u128(int k) {
+    return k == 0? 1 : 10 * pow10_u128(k - 1);
+}
+
+// %.16g для нецелого value из [1e-6, 2^52): value = m * 2^e точно, нужные 16
+// цифр - это m * 10^k / 2^-e, округлённое к ближайшему (половина - к чётному,
+// как в printf). При таком диапазоне произведение помещается в 128 бит.
+inline int write_g16_exact(char *out, double value) {
+    static const uint128 pow10[] = {
+        pow10_u128(0), pow10_u128(1), pow10_u128(2), pow10_u128(3), pow10_u128(4),
+        pow10_u128(5), pow10_u128(6), pow10_u128(7), pow10_u128(8), pow10_u128(9),
+        pow10_u128(10), pow10_u128(11), pow10_u128(12), pow10_u128(13), pow10_u128(14),
+        pow10_u128(15), pow10_u128(16), pow10_u128(17), pow10_u128(18), pow10_u128(19),
+        pow10_u128(20), pow10_u128(21), pow10_u128(22)
+    };
+    const uint128 low = pow10[15], high = pow10[16];
+
+    int exp2;
+    double fraction = std::frexp(value, &exp2);
+    uint128 mantissa = (uint64_t)std::ldexp(fraction, 53);
+    int shift = 53 - exp2;
+
+    // десятичный порядок: log10 может ошибиться на единицу у степеней десяти
+    int exp10 = (int)std::floor(std::log10(value));
+    uint128 digits;
+    while (true) {
+        uint128 scaled = mantissa * pow10[15 - exp10];
+        digits = scaled >> shift;
+        if (digits < low) {
+            exp10--;
+            continue;
+        }
+        if (digits >= high) {
+            exp10++;
+            continue;
+        }
+        uint128 rest = scaled - (digits << shift);
+        uint128 half = (uint128)1 << (shift - 1);
+        if (rest > half || (rest == half && (digits & 1))) {
+            digits++;
+            if (digits == high) {
+                digits = low;
+                exp10++;
+            }
+        }
+        break;
+    }
+
+    char buffer[16];
+    uint64_t rest = (uint64_t)digits;
+    for (int I = 15; I >= 0; I--) {
+        buffer[I] = char('0' + rest % 10);
+        rest /= 10;
+    }
+    int count = 16;
+    while (buffer[count - 1] == '0') {
+        count--;
+    }
+
+    char *p = out;
+    if (exp10 < -4) {
+        *p++ = buffer[0];
+        if (count > 1) {
+            *p++ = '.';
+            for (int I = 1; I < count; I++) {
+                *p++ = buffer[I];
+            }
+        }
+        *p++ = 'e';
+        *p++ = '-';
+        int exponent = -exp10;
+        if (exponent < 10) {
+            *p++ = '0';
+        }
+        p += write_unsigned(p, exponent);
+    }
+    else if (exp10 < 0) {
+        *p++ = '0';
+        *p++ = '.';
+        for (int I = -1; I > exp10; I--) {
+            *p++ = '0';
+        }
+        for (int I = 0; I < count; I++) {
+            *p++ = buffer[I];
+        }
+    }
+    else {
+        for (int I = 0; I <= exp10; I++) {
+            *p++ = I < count? buffer[I] : '0';
+        }
+        if (count > exp10 + 1) {
+            *p++ = '.';
+            for (int I = exp10 + 1; I < count; I++) {
+                *p++ = buffer[I];
+            }
+        }
+    }
+    return p - out;
+}
+#endif
+
+// как snprintf(out, NUMBER_BUFFER_SIZE, "%.16g", value), возвращает длину
+inline int write_number(char *out, double value) {
+    if (std::isnan(value) || std::isinf(value)) {
+        return std::snprintf(out, NUMBER_BUFFER_SIZE, "%.16g", value);
+    }
+    char *p = out;
+    if (std::signbit(value)) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value < 1e16 && value == std::floor(value)) {
+        return p - out + write_unsigned(p, (unsigned long long)value);
+    }
+#ifdef __SIZEOF_INT128__
+    if (value >= 1e-6 && value < 1e16) {
+        return p - out + write_g16_exact(p, value);
+    }
+#endif
+    return p - out + std::snprintf(p, NUMBER_BUFFER_SIZE - 1, "%.16g", value);
+}
+
+inline void append_number(std::string &out, double value) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    out.append(buffer, write_number(buffer, value));
+}
+
+inline void append_number(std::string &out, long long value) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    char *p = buffer;
+    unsigned long long magnitude = value;
+    if (value < 0) {
+        *p++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    p += write_unsigned(p, magnitude);
+    out.append(buffer, p - buffer);
+}
+
+inline void append_number(std::string &out, int value) {
+    append_number(out, (long long)value);
+}
+
+
+// id игрока, как Player::id_to_str
+struct LogPlayerId
+{
+    int id, fragment_id;
+};
+
+// строка в кавычках сообщения: переводы строк и кавычки экранируются
+struct LogEscaped
+{
+    const std::string &text;
+};
+
+inline void append_arg(std::string &out, double value) {
+    append_number(out, value);
+}
+
+inline void append_arg(std::string &out, int value) {
+    append_number(out, value);
+}
+
+inline void append_arg(std::string &out, long long value) {
+    append_number(out, value);
+}
+
+inline void append_arg(std::string &out, const char *text) {
+    out += text;
+}
+
+inline void append_arg(std::string &out, const std::string &text) {
+    out += text;
+}
+
+inline void append_arg(std::string &out, const LogPlayerId &player) {
+    append_number(out, player.id);
+    if (player.fragment_id > 0) {
+        out += '.';
+        append_number(out, player.fragment_id);
+    }
+}
+
+inline void append_arg(std::string &out, const LogEscaped &escaped) {
+    for (char c : escaped.text) {
+        if (c == '\n') {
+            out += "\\n";
+        } else if (c == '"') {
+            out += "\\\"";
+        } else {
+            out += c;
+        }
+    }
+}
+
+inline void append_format(std::string &out, const char *pattern) {
+    out += pattern;
+}
+
+// дописывает pattern, подставляя аргументы по порядку вместо {}
+template <typename T, typename... Args>
+void append_format(std::string &out, const char *pattern, const T &arg, const Args&... args) {
+    const char *p = pattern;
+    while (*p != '\0' && ! (p[0] == '{' && p[1] == '}')) {
+        p++;
+    }
+    out.append(pattern, p - pattern);
+    if (*p == '\0') {
+        return;
+    }
+    append_arg(out, arg);
+    append_format(out, p + 2, args...);
+}
+
+#endif // LOG_FORMAT_H
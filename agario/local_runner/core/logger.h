@@ -0,0 +1,921 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "entities/food.h"
+#include "entities/virus.h"
+#include "entities/player.h"
+#include "entities/ejection.h"
+#include "replay_format.h"
+#include "replay_index.h"
+#include "spsc_queue.h"
+#include "wire_format.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "zlib.h"
+
+#define CHUNK 16384
+// накопленный лог уходит на диск и в архив, когда дорастает до этого размера
+#define STREAM_CHUNK (1 << 20)
+// записей в очереди фонового писателя (степень двойки)
+#define LOG_QUEUE_SIZE (1 << 15)
+// не чаще чем через столько байт текста ставится точка полного сброса в .gz
+#define INDEX_GZ_SPACING (1 << 18)
+
+
+inline std::string &replace_all(std::string &src, const std::string &before, const std::string &after) {
+    size_t pos = 0;
+    while ((pos = src.find(before, pos)) != std::string::npos) {
+        src.replace(pos, before.length(), after);
+        pos += after.length();
+    }
+    return src;
+}
+
+inline std::string replaced(std::string src, const std::string &before, const std::string &after) {
+    return replace_all(src, before, after);
+}
+
+// Лог игры. Обычно события форматируются и пишутся сразу, в потоке игры.
+// В асинхронном режиме (set_async) поток игры только складывает LogRecord в
+// очередь, а форматирование, сжатие и запись на диск делает отдельный поток,
+// так что длительность тика не зависит от диска и zlib. Порядок записей
+// сохраняется, поэтому лог побайтно такой же. flush() в этом режиме ждёт,
+// пока писатель дойдёт до него; остальные вызовы не ждут.
+//
+// С set_binary рядом с текстовым логом пишется двоичный (path + ".bin", формат
+// в replay_format.h) с точными числами: заголовок игры в нём лежит текстом,
+// строка OD - отдельным куском (её правит rewrite_game_ticks), остальное -
+// записи, в том числе на тике 0.
+//
+// С set_index при завершении лога рядом пишется индекс ключевых кадров
+// (path + ".idx", см. replay_index.h): смещения начала каждого базового тика
+// в логе, в .gz и в .bin. В режиме autoflush индекс не ведётся.
+//
+// С set_capture лог не пишется в файлы, а копится в памяти, откуда его
+// забирает take_captured (проверка повтора сравнивает его с записанным).
+class Logger
+{
+private:
+    GameConfig config;
+    int current_tick;
+    std::string file_name;
+    std::string path;
+    std::string content;
+    bool autoflush;
+    bool capture;
+
+    // Потоковая запись. Блок тика 0 (заголовок с OD ... G{ticks}) пишется в .gz
+    // отдельным несжатым gzip-членом, остальное сжимается по мере накопления во
+    // второй член. Так rewrite_game_ticks после записи заголовка правит только
+    // начало файлов, а не держит весь лог в памяти до конца игры.
+    bool streaming;
+    size_t head_size;           // длина блока тика 0 в content, пока он не записан
+    std::string head;           // записанный заголовок
+    std::string head_member;    // его gzip-член в начале .gz
+    std::string new_head;       // заголовок после rewrite_game_ticks
+    std::ofstream plain_file;
+    std::ofstream archive_file;
+    z_stream body_stream;
+
+    // двоичный лог
+    bool binary;
+    BinaryLogWriter binary_writer;
+    std::string binary_content;     // записи, ещё не в файле
+    size_t binary_head_size;        // длина блока тика 0 в binary_content, пока он не записан
+    std::string binary_head;        // записанный заголовок двоичного лога
+    std::string new_binary_head;    // он же после rewrite_game_ticks
+    std::ofstream binary_file;
+
+    // индекс ключевых кадров
+    bool indexing;
+    std::vector<ReplayKeyframe> keyframes;
+    long long plain_written;        // байт записано в лог
+    long long archive_written;      // в .gz
+    long long binary_written;       // в .bin
+    ReplayKeyframe gz_point;        // последняя точка полного сброса в .gz
+
+    // асинхронный режим
+    LogRecord sync_record;          // запись синхронного режима
+    SpscQueue<LogRecord> *queue;    // NULL - синхронный режим
+    std::thread writer;
+    std::mutex writer_mutex;
+    std::condition_variable writer_wake;
+    std::condition_variable writer_done;
+    std::atomic<bool> writer_idle;
+    bool writer_stop;               // под writer_mutex
+    size_t flush_requested;         // только поток игры
+    size_t flush_done;              // под writer_mutex
+
+public:
+    explicit Logger(const GameConfig &_config) :
+        config(_config),
+        current_tick(0),
+        autoflush(false),
+        capture(false),
+        streaming(false),
+        head_size(std::string::npos),
+        binary(false),
+        binary_head_size(std::string::npos),
+        indexing(false),
+        plain_written(0),
+        archive_written(0),
+        binary_written(0),
+        queue(NULL),
+        writer_idle(false),
+        writer_stop(false),
+        flush_requested(0),
+        flush_done(0)
+    {}
+
+    virtual ~Logger() {
+        set_async(false);
+        stop_streaming();
+    }
+
+    // Включает/выключает фоновый поток записи. При выключении дожидается,
+    // пока поток допишет всё, что уже в очереди.
+    void set_async(bool enabled) {
+        if (enabled && queue == NULL) {
+            queue = new SpscQueue<LogRecord>(LOG_QUEUE_SIZE);
+            writer_stop = false;
+            writer = std::thread(&Logger::run_writer, this);
+        }
+        else if (! enabled && queue != NULL) {
+            {
+                std::lock_guard<std::mutex> lock(writer_mutex);
+                writer_stop = true;
+            }
+            writer_wake.notify_one();
+            writer.join();
+            delete queue;
+            queue = NULL;
+        }
+    }
+
+    bool is_async() const {
+        return queue != NULL;
+    }
+
+    void init_file(const std::string &part, const std::string &basename, bool debug=true) {
+//        QString f = (!debug)? LOG_FILE : DEBUG_FILE;
+        // имя и путь читаются из потока игры, поэтому задаются здесь, до записи
+        file_name = replaced(basename, "{1}", part);
+        path = config.LOG_DIR + file_name;
+        LogRecord &record = begin_record(LOG_INIT, 0);
+        record.text = part;
+        record.num = debug;
+        end_record();
+    }
+
+    std::string get_file_name() const {
+        return file_name;
+    }
+
+    std::string get_path() const {
+        return path;
+    }
+
+    // сбрасывать накопленное в файл при каждой смене тика (локальный раннер)
+    void set_autoflush(bool enabled) {
+        begin_record(LOG_AUTOFLUSH, 0).num = enabled;
+        end_record();
+    }
+
+    void clear_file() {
+        begin_record(LOG_CLEAR, 0);
+        end_record();
+    }
+
+    // писать ли двоичный лог; float32 - координаты во float (с потерей точности).
+    // Включать до init_file: заголовок игры попадает в двоичный лог при его записи
+    void set_binary(bool enabled, bool float32=false) {
+        begin_record(LOG_BINARY, 0).num = (enabled? 1 : 0) | (float32? 2 : 0);
+        end_record();
+    }
+
+    std::string get_binary_path() const {
+        return path + ".bin";
+    }
+
+    // писать ли индекс ключевых кадров
+    void set_index(bool enabled) {
+        begin_record(LOG_INDEX, 0).num = enabled;
+        end_record();
+    }
+
+    std::string get_index_path() const {
+        return replay_index_path(path);
+    }
+
+    // не писать файлы, а копить лог для take_captured
+    void set_capture(bool enabled) {
+        begin_record(LOG_CAPTURE, 0).num = enabled;
+        end_record();
+    }
+
+    // Дописывает в out накопленный с прошлого вызова текст. Только в
+    // синхронном режиме: в асинхронном текст формирует поток писателя.
+    void take_captured(std::string &out) {
+        out += content;
+        content.clear();
+    }
+
+    // Без архива дописывает накопленное в файл. С архивом завершает запись лога
+    // и .gz; всё, что было записано раньше потоком, уже лежит в обоих файлах.
+    void flush(bool need_compress=true) {
+        begin_record(LOG_FLUSH, 0).num = need_compress;
+        end_record();
+        if (queue == NULL) {
+            return;
+        }
+        size_t ticket = ++flush_requested;
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        writer_wake.notify_one();
+        writer_done.wait(lock, [this, ticket] { return flush_done >= ticket; });
+    }
+
+    bool compress(const std::string &data, std::string &result, int level=Z_DEFAULT_COMPRESSION) {
+
+        unsigned char out[CHUNK];
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        if (deflateInit2(&strm, level, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        strm.next_in = (unsigned char*)data.c_str();
+        strm.avail_in = data.size();
+        do {
+            int have;
+            strm.avail_out = CHUNK;
+            strm.next_out = out;
+            if (deflate(&strm, Z_FINISH) == Z_STREAM_ERROR) {
+                return false;
+            }
+            have = CHUNK - strm.avail_out;
+            result.append((char*)out, have);
+        }
+        while (strm.avail_out == 0);
+
+        if (deflateEnd(&strm) != Z_OK) {
+            return false;
+        }
+        return true;
+    }
+
+    void write_add_cmd(int tick, Food *food) {
+        LogRecord &record = begin_record(LOG_ADD_FOOD, tick);
+        record.id = food->getId();
+        record.v[0] = food->getX();
+        record.v[1] = food->getY();
+        end_record();
+    }
+
+    void write_add_cmd(int tick, Virus *virus) {
+        LogRecord &record = begin_record(LOG_ADD_VIRUS, tick);
+        record.id = virus->getId();
+        record.v[0] = virus->getX();
+        record.v[1] = virus->getY();
+        end_record();
+    }
+
+    void write_add_cmd(int tick, Player *player) {
+        LogRecord &record = begin_player_record(LOG_ADD_PLAYER, tick, player);
+        record.v[0] = player->getX();
+        record.v[1] = player->getY();
+        record.v[2] = player->getR();
+        record.v[3] = player->getM();
+        record.v[4] = player->getVR();
+        record.num = player->getC();
+        end_record();
+    }
+
+    void write_add_cmd(int tick, Ejection *eject) {
+        LogRecord &record = begin_record(LOG_ADD_EJECT, tick);
+        record.id = eject->getId();
+        record.v[0] = eject->getX();
+        record.v[1] = eject->getY();
+        record.num = eject->get_player();
+        end_record();
+    }
+
+    void write_direct(int tick, int id, Direct direct) {
+        LogRecord &record = begin_record(LOG_DIRECT, tick);
+        record.id = id;
+        record.v[0] = direct.x;
+        record.v[1] = direct.y;
+        end_record();
+    }
+
+    void write_direct_for(int tick, Player *player, Direct direct) {
+        LogRecord &record = begin_player_record(LOG_DIRECT_FOR, tick, player);
+        std::pair<double, double> norm = player->get_direct();
+        record.v[0] = norm.first;
+        record.v[1] = norm.second;
+        record.num = direct.split? 'S' : direct.eject? 'E' : 0;
+        end_record();
+    }
+
+    void write_fog_for(int tick, Player *player) {
+        begin_player_record(LOG_FOG, tick, player).v[0] = player->getVR();
+        end_record();
+    }
+
+    void write_kill_cmd(int tick, Food *food) {
+        begin_record(LOG_KILL_FOOD, tick).id = food->getId();
+        end_record();
+    }
+
+    void write_kill_cmd(int tick, Player *player) {
+        begin_player_record(LOG_KILL_PLAYER, tick, player);
+        end_record();
+    }
+
+    void write_kill_cmd(int tick, Virus *virus) {
+        begin_record(LOG_KILL_VIRUS, tick).id = virus->getId();
+        end_record();
+    }
+
+    void write_kill_cmd(int tick, Ejection *eject) {
+        begin_record(LOG_KILL_EJECT, tick).id = eject->getId();
+        end_record();
+    }
+
+    void write_change_pos(int tick, Player *player) {
+        LogRecord &record = begin_player_record(LOG_POS_PLAYER, tick, player);
+        record.v[0] = player->getX();
+        record.v[1] = player->getY();
+        record.v[2] = player->getA();
+        record.v[3] = player->get_speed();
+        end_record();
+    }
+
+    void write_change_pos(int tick, Ejection *eject) {
+        LogRecord &record = begin_record(LOG_POS_EJECT, tick);
+        record.id = eject->getId();
+        record.v[0] = eject->getX();
+        record.v[1] = eject->getY();
+        record.v[2] = eject->get_angle();
+        record.v[3] = eject->get_speed();
+        record.num = eject->get_player();
+        end_record();
+    }
+
+    void write_change_pos(int tick, Virus *virus) {
+        LogRecord &record = begin_record(LOG_POS_VIRUS, tick);
+        record.id = virus->getId();
+        record.v[0] = virus->getX();
+        record.v[1] = virus->getY();
+        record.v[2] = virus->getM();
+        record.v[3] = virus->get_angle();
+        record.v[4] = virus->get_speed();
+        end_record();
+    }
+
+    void write_change_mass(int tick, Player *player) {
+        LogRecord &record = begin_player_record(LOG_MASS, tick, player);
+        record.v[0] = player->getX();
+        record.v[1] = player->getY();
+        record.v[2] = player->getR();
+        record.v[3] = player->getM();
+        end_record();
+    }
+
+    void write_change_mass_id(int tick, const std::string &old_id, Player *player) {
+        LogRecord &record = begin_player_record(LOG_MASS_ID, tick, player);
+        record.text = old_id;
+        record.v[0] = player->getR();
+        record.v[1] = player->getM();
+        end_record();
+    }
+
+    void write_change_id(int tick, const std::string &old_id, Player *player) {
+        begin_player_record(LOG_CHANGE_ID, tick, player).text = old_id;
+        end_record();
+    }
+
+    inline std::string escape(const std::string &src) {
+        std::string result;
+        append_arg(result, LogEscaped{src});
+        return result;
+    }
+
+    void write_debug(int tick, int pId, const std::string &msg) {
+        write_message(LOG_DEBUG, tick, pId, msg);
+    }
+
+    void write_to_sprite(int tick, int pId, const std::string &playerId, const std::string &msg) {
+        LogRecord &record = begin_record(LOG_SPRITE, tick);
+        record.id = pId;
+        record.text = playerId;
+        record.extra = msg;
+        end_record();
+    }
+
+    void write_error(int tick, int pId, const std::string &error) {
+        write_message(LOG_ERROR, tick, pId, error);
+    }
+
+    void write_error(int pId, const std::string &error) {
+        write_message(LOG_ERROR, LOG_CURRENT_TICK, pId, error);
+    }
+
+    void write_solution_id(int pId, const std::string &solution_id) {
+        write_message(LOG_SOLUTION_ID, LOG_CURRENT_TICK, pId, solution_id);
+    }
+
+    void write_player_score(int tick, int pId, int score) {
+        LogRecord &record = begin_record(LOG_SCORE, tick);
+        record.id = pId;
+        record.num = score;
+        end_record();
+    }
+
+    void rewrite_game_ticks(int ticks) {
+        begin_record(LOG_REWRITE_TICKS, 0).num = ticks;
+        end_record();
+    }
+
+    void write_raw(int tick, const std::string &raw) {
+        begin_record(LOG_RAW, tick).text = raw;
+        end_record();
+    }
+
+    // сообщение, которое заодно уходит в сокет: запись держит ссылку на него
+    void write_raw(int tick, const SharedBuffer &raw) {
+        begin_record(LOG_RAW, tick).shared = raw;
+        end_record();
+    }
+
+    // Состояние, ушедшее двоичному клиенту (кадр wire_format.h). В лог оно
+    // попадает тем же JSON, что у текстовых клиентов, но собирает его
+    // писатель лога, а не поток игры.
+    void write_wire_state(int tick, const SharedBuffer &frame) {
+        begin_record(LOG_WIRE_STATE, tick).shared = frame;
+        end_record();
+    }
+
+    void write_raw_with_old_tick(const std::string &raw) {
+        write_raw(LOG_CURRENT_TICK, raw);
+    }
+
+private:
+    // Запись для заполнения: в синхронном режиме - своя, в асинхронном -
+    // свободная ячейка очереди. Заполненную запись отдаёт end_record().
+    LogRecord &begin_record(int kind, int tick) {
+        LogRecord *record = &sync_record;
+        if (queue != NULL) {
+            // очередь полна: будим писателя и ждём, пока он её разгрузит
+            while ((record = queue->acquire()) == NULL) {
+                writer_wake.notify_one();
+                std::this_thread::yield();
+            }
+        }
+        record->kind = kind;
+        record->tick = tick;
+        return *record;
+    }
+
+    LogRecord &begin_player_record(int kind, int tick, Player *player) {
+        LogRecord &record = begin_record(kind, tick);
+        record.id = player->getId();
+        record.fragment_id = player->get_fId();
+        return record;
+    }
+
+    void end_record() {
+        if (queue == NULL) {
+            apply(sync_record);
+            sync_record.shared.reset();
+            return;
+        }
+        queue->push();
+        // Писатель засыпает с таймаутом, так что пропущенное здесь пробуждение
+        // только задержит запись, а будить на каждой записи дорого.
+        if (writer_idle.load(std::memory_order_relaxed)) {
+            writer_wake.notify_one();
+        }
+    }
+
+    void write_message(int kind, int tick, int pId, const std::string &msg) {
+        LogRecord &record = begin_record(kind, tick);
+        record.id = pId;
+        record.text = msg;
+        end_record();
+    }
+
+    void run_writer() {
+        while (true) {
+            LogRecord *record = queue->front();
+            if (record != NULL) {
+                apply(*record);
+                // ячейка очереди живёт дольше записи: сообщение отпускаем сразу
+                record->shared.reset();
+                bool is_flush = record->kind == LOG_FLUSH;
+                queue->pop();
+                if (is_flush) {
+                    std::lock_guard<std::mutex> lock(writer_mutex);
+                    flush_done++;
+                    writer_done.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            if (writer_stop && queue->empty()) {
+                break;
+            }
+            writer_idle.store(true);
+            writer_wake.wait_for(lock, std::chrono::milliseconds(1));
+            writer_idle.store(false);
+        }
+    }
+
+    // форматирует запись прямо в content; в асинхронном режиме - поток писателя
+    void apply(const LogRecord &record) {
+        int tick = record.tick == LOG_CURRENT_TICK? current_tick : record.tick;
+        switch (record.kind) {
+        case LOG_INIT:
+            clear_content();
+            if (! record.num) {
+                write_header(record.text);
+            }
+            break;
+        case LOG_CLEAR:
+            clear_content();
+            break;
+        case LOG_FLUSH:
+            flush_content(record.num != 0);
+            break;
+        case LOG_REWRITE_TICKS:
+            rewrite_ticks(record.num);
+            break;
+        case LOG_AUTOFLUSH:
+            autoflush = record.num != 0;
+            break;
+        case LOG_BINARY:
+            binary = (record.num & 1) != 0;
+            binary_writer = BinaryLogWriter((record.num & 2) != 0);
+            break;
+        case LOG_INDEX:
+            indexing = record.num != 0;
+            break;
+        case LOG_CAPTURE:
+            capture = record.num != 0;
+            break;
+        case LOG_WIRE_STATE:
+            write_wire_state_line(tick, record);
+            break;
+        default:
+            write_line(tick, record);
+        }
+    }
+
+    void write_wire_state_line(int tick, const LogRecord &record) {
+        const std::string &frame = *record.shared;
+        std::string &out = begin_line(tick);
+        size_t start = out.size();
+        if (frame.size() >= WIRE_LENGTH_SIZE) {
+            WireReader reader(frame.data() + WIRE_LENGTH_SIZE, frame.size() - WIRE_LENGTH_SIZE);
+            if (reader.read_state_json(out)) {
+                if (binary) {
+                    binary_writer.text(binary_content, out.data() + start, out.size() - start);
+                }
+                return;
+            }
+        }
+        out.resize(start);
+    }
+
+    void write_line(int tick, const LogRecord &record) {
+        std::string &out = begin_line(tick);
+        size_t start = out.size();
+        append_log_line(out, record);
+        if (binary && ! binary_writer.record(binary_content, record)) {
+            binary_writer.text(binary_content, out.data() + start, out.size() - start);
+        }
+    }
+
+    // буфер, в который дописывается строка тика tick; при смене тика
+    // отправляет накопленное дальше и ставит метку T
+    std::string &begin_line(int tick) {
+        if (tick != current_tick) {
+            if (head_size == std::string::npos) {
+                head_size = content.size();
+                binary_head_size = binary_content.size();
+            }
+            bool keyframe = indexing && ! autoflush && ! capture && tick != 0 && tick % config.BASE_TICK == 0;
+            if (capture) {
+                // всё остаётся в content до take_captured
+            } else if (autoflush) {
+                flush_content(false);
+            } else if (keyframe) {
+                add_keyframe(tick);
+            } else if (content.size() >= STREAM_CHUNK) {
+                stream();
+            }
+
+            if (tick != 0) {
+                append_tick_line(content, tick);
+                if (binary) {
+                    if (keyframe) {
+                        binary_writer.keyframe(binary_content);
+                    }
+                    binary_writer.tick(binary_content, tick);
+                }
+            }
+            current_tick = tick;
+        }
+        return content;
+    }
+
+    // Ключевой кадр: всё до него уходит в файлы, так что смещения известны.
+    // В .gz полный сброс (с него можно начать распаковку) ставится не на
+    // каждом кадре, чтобы не портить сжатие; кадр ссылается на последний.
+    void add_keyframe(int tick) {
+        long long since_point = plain_written + content.size() - gz_point.log_offset;
+        stream(since_point >= INDEX_GZ_SPACING? Z_FULL_FLUSH : Z_NO_FLUSH);
+        if (! streaming) {
+            return;
+        }
+        if (since_point >= INDEX_GZ_SPACING) {
+            gz_point.gz_offset = archive_written;
+            gz_point.gz_log_offset = plain_written;
+            gz_point.log_offset = plain_written;
+        }
+        ReplayKeyframe frame;
+        frame.tick = tick;
+        frame.log_offset = plain_written;
+        frame.gz_offset = gz_point.gz_offset;
+        frame.gz_log_offset = gz_point.gz_log_offset;
+        frame.bin_offset = binary_file.is_open()? binary_written : -1;
+        keyframes.push_back(frame);
+    }
+
+    void clear_content() {
+        if (capture) {
+            content.clear();
+            head_size = std::string::npos;
+            binary_head_size = std::string::npos;
+            return;
+        }
+        stop_streaming();
+        plain_file.close();
+        binary_file.close();
+        binary_content.clear();
+        binary_head_size = std::string::npos;
+        binary_writer.reset();
+        std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        content.clear();
+        head_size = std::string::npos;
+        keyframes.clear();
+        plain_written = archive_written = binary_written = 0;
+        gz_point = ReplayKeyframe();
+    }
+
+    // пишет индекс, сдвинув смещения кадров на изменение длины заголовков
+    void write_index(long long log_shift, long long gz_shift, long long bin_shift) {
+        std::vector<ReplayKeyframe> frames(1, ReplayKeyframe());
+        for (ReplayKeyframe frame : keyframes) {
+            frame.log_offset += log_shift;
+            if (frame.gz_offset != 0) {
+                frame.gz_offset += gz_shift;
+                frame.gz_log_offset += log_shift;
+            }
+            if (frame.bin_offset >= 0) {
+                frame.bin_offset += bin_shift;
+            }
+            frames.push_back(frame);
+        }
+        write_replay_index(get_index_path(), config.BASE_TICK, frames);
+    }
+
+    void flush_content(bool need_compress) {
+        if (capture) {
+            return;
+        }
+        if (! need_compress && ! streaming) {
+            stream_binary();
+            // файл держим открытым: при autoflush сюда приходим каждый тик
+            if (! plain_file.is_open()) {
+                plain_file.open(path, std::ios::out | std::ios::app | std::ios::binary);
+            }
+            plain_file << content;
+            plain_file.flush();
+            plain_written += content.size();
+            content.clear();
+            return;
+        }
+        stream();
+        if (! need_compress) {
+            return;
+        }
+        bool was_streaming = streaming;
+        if (streaming) {
+            deflate_body(Z_FINISH);
+        }
+        bool rewrite_head = streaming && new_head != head;
+        stop_streaming();
+        bool rewrite_binary = binary_file.is_open() && new_binary_head != binary_head;
+        binary_file.close();
+        // дальнейшие записи - уже не заголовок игры
+        head_size = 0;
+        long long log_shift = 0, gz_shift = 0, bin_shift = 0;
+        if (rewrite_head) {
+            std::string member;
+            if (compress(new_head, member, Z_NO_COMPRESSION)) {
+                replace_prefix(path, head.size(), new_head);
+                replace_prefix(path + ".gz", head_member.size(), member);
+                log_shift = (long long)new_head.size() - (long long)head.size();
+                gz_shift = (long long)member.size() - (long long)head_member.size();
+            }
+        }
+        if (rewrite_binary) {
+            replace_prefix(get_binary_path(), binary_head.size(), new_binary_head);
+            bin_shift = (long long)new_binary_head.size() - (long long)binary_head.size();
+        }
+        if (indexing && was_streaming) {
+            write_index(log_shift, gz_shift, bin_shift);
+        }
+    }
+
+    void rewrite_ticks(int ticks) {
+        std::string oldLine, newLine;
+        append_format(oldLine, "OD T{} G{} B{}\n", config.TICK_MS, config.GAME_TICKS, config.BASE_TICK);
+        append_format(newLine, "OD T{} G{} B{}\n", config.TICK_MS, ticks, config.BASE_TICK);
+        // в двоичном логе строка OD - отдельный кусок текста
+        std::string oldChunk, newChunk;
+        binary_writer.text(oldChunk, oldLine.data(), oldLine.size());
+        binary_writer.text(newChunk, newLine.data(), newLine.size());
+        if (streaming) {
+            // заголовок уже в файле: поправим при завершении (flush)
+            new_head = replaced(head, oldLine, newLine);
+            new_binary_head = replaced(binary_head, oldChunk, newChunk);
+        } else {
+            replace_in_head(content, head_size, oldLine, newLine);
+            if (! binary_file.is_open()) {
+                replace_in_head(binary_content, binary_head_size, oldChunk, newChunk);
+            }
+        }
+    }
+
+    // заголовок ещё в буфере: его длина (head_size) меняется вместе с ним
+    static void replace_in_head(std::string &buffer, size_t &head_size, const std::string &before, const std::string &after) {
+        size_t pos = 0;
+        while ((pos = buffer.find(before, pos)) != std::string::npos) {
+            buffer.replace(pos, before.size(), after);
+            if (head_size != std::string::npos && pos < head_size) {
+                head_size = head_size - before.size() + after.size();
+            }
+            pos += after.size();
+        }
+    }
+
+    // отправляет накопленное в файл и в архив, при первом вызове пишет заголовок;
+    // flush_mode - режим deflate для архива (Z_FULL_FLUSH у ключевых кадров)
+    void stream(int flush_mode=Z_NO_FLUSH) {
+        stream_binary();
+        if (! streaming) {
+            if (! start_streaming()) {
+                return;
+            }
+        }
+        plain_file << content;
+        plain_written += content.size();
+        body_stream.next_in = (unsigned char*)content.data();
+        body_stream.avail_in = content.size();
+        deflate_body(flush_mode);
+        content.clear();
+    }
+
+    // дописывает записи двоичного лога, при первом вызове - с заголовком;
+    // зовётся до того, как content уйдёт в текстовый файл
+    void stream_binary() {
+        if (! binary) {
+            return;
+        }
+        if (! binary_file.is_open()) {
+            binary_file.open(get_binary_path(), std::ios::out | std::ios::trunc | std::ios::binary);
+            size_t size = std::min(binary_head_size, binary_content.size());
+            binary_head.clear();
+            binary_writer.begin(binary_head);
+            binary_head.append(binary_content, 0, size);
+            new_binary_head = binary_head;
+            binary_content.erase(0, size);
+            binary_file << binary_head;
+            binary_written += binary_head.size();
+        }
+        binary_file << binary_content;
+        binary_written += binary_content.size();
+        binary_content.clear();
+    }
+
+    bool start_streaming() {
+        if (! plain_file.is_open()) {
+            plain_file.open(path, std::ios::out | std::ios::app | std::ios::binary);
+        }
+        archive_file.open(path + ".gz", std::ios::out | std::ios::trunc | std::ios::binary);
+        body_stream.zalloc = Z_NULL;
+        body_stream.zfree = Z_NULL;
+        body_stream.opaque = Z_NULL;
+        if (! plain_file.is_open() || ! archive_file.is_open() ||
+                deflateInit2(&body_stream, -1, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            plain_file.close();
+            archive_file.close();
+            return false;
+        }
+        streaming = true;
+
+        size_t size = std::min(head_size, content.size());
+        head.assign(content, 0, size);
+        new_head = head;
+        content.erase(0, size);
+        head_member.clear();
+        compress(head, head_member, Z_NO_COMPRESSION);
+        plain_file << head;
+        archive_file << head_member;
+        plain_written += head.size();
+        archive_written += head_member.size();
+        return true;
+    }
+
+    void deflate_body(int flush_mode) {
+        unsigned char out[CHUNK];
+        do {
+            body_stream.avail_out = CHUNK;
+            body_stream.next_out = out;
+            if (deflate(&body_stream, flush_mode) == Z_STREAM_ERROR) {
+                return;
+            }
+            archive_file.write((char*)out, CHUNK - body_stream.avail_out);
+            archive_written += CHUNK - body_stream.avail_out;
+        }
+        while (body_stream.avail_out == 0);
+    }
+
+    void stop_streaming() {
+        if (! streaming) {
+            return;
+        }
+        deflateEnd(&body_stream);
+        plain_file.close();
+        archive_file.close();
+        streaming = false;
+    }
+
+    // заменяет первые old_size байт файла на prefix; при другой длине
+    // переписывает файл кусками через временный
+    static void replace_prefix(const std::string &file_path, size_t old_size, const std::string &prefix) {
+        if (prefix.size() == old_size) {
+            std::fstream file(file_path, std::ios::in | std::ios::out | std::ios::binary);
+            file.write(prefix.data(), prefix.size());
+            return;
+        }
+        std::string tmp_path = file_path + ".tmp";
+        {
+            std::ifstream src(file_path, std::ios::in | std::ios::binary);
+            std::ofstream dst(tmp_path, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (! src.is_open() || ! dst.is_open()) {
+                return;
+            }
+            dst << prefix;
+            src.seekg(old_size);
+            char buffer[CHUNK];
+            while (src.read(buffer, sizeof(buffer)) || src.gcount() > 0) {
+                dst.write(buffer, src.gcount());
+            }
+        }
+        std::rename(tmp_path.c_str(), file_path.c_str());
+    }
+
+    void write_header(const std::string &seed) {
+        std::string &out = begin_line(0);
+        size_t start = out.size();
+        out += "# O=Options, A=Add, +=Change K=Kill, C=Command, T=Tick, W=World, F=Food, P=Player, V=Virus, E=Ejection\n";
+        append_format(out, "# Dynamic params VISCOSITY={} FOOD_MASS={} MAX_FRAGS_CNT={} TICKS_TIL_FUSION={} INERTION_FACTOR={} VIRUS_SPLIT_MASS={} SPEED_FACTOR={} VIRUS_RADIUS={}\n",
+                      config.VISCOSITY, config.FOOD_MASS, config.MAX_FRAGS_CNT, config.TICKS_TIL_FUSION, config.INERTION_FACTOR, config.VIRUS_SPLIT_MASS, config.SPEED_FACTOR, config.VIRUS_RADIUS);
+        size_t game_line = out.size();
+        append_format(out, "OD T{} G{} B{}\n", config.TICK_MS, config.GAME_TICKS, config.BASE_TICK);
+        size_t game_line_end = out.size();
+        append_format(out, "OW W{} H{} S{}\n", config.GAME_WIDTH, config.GAME_HEIGHT, seed);
+        append_format(out, "OF R{} M{}\n", FOOD_RADIUS, config.FOOD_MASS);
+        append_format(out, "OV R{} M{}\n", config.VIRUS_RADIUS, VIRUS_MASS);
+        append_format(out, "OP R{} M{}\n", PLAYER_RADIUS, PLAYER_MASS);
+        append_format(out, "OE R{} M{}\n", EJECT_RADIUS, EJECT_MASS);
+        append_format(out, "OFog S{}\n", VIS_SHIFT);
+        if (binary) {
+            binary_writer.text(binary_content, out.data() + start, game_line - start);
+            binary_writer.text(binary_content, out.data() + game_line, game_line_end - game_line);
+            binary_writer.text(binary_content, out.data() + game_line_end, out.size() - game_line_end);
+        }
+    }
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,83 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+
+// Файл, отображённый в память только для чтения. Если mmap не вышел (пустой
+// файл, не обычный файл), содержимое читается в буфер, так что data() есть
+// всегда, когда open() вернул true.
+class MappedFile
+{
+private:
+    const char *mapped;
+    size_t mapped_size;
+    std::string buffer;
+
+    MappedFile(const MappedFile&);
+    MappedFile &operator=(const MappedFile&);
+
+public:
+    MappedFile() :
+        mapped(NULL),
+        mapped_size(0)
+    {}
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string &file_path) {
+        close();
+        int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void *address = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                mapped = (const char*)address;
+                mapped_size = info.st_size;
+                // файл читается один раз от начала до конца
+                madvise(address, mapped_size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        if (mapped != NULL) {
+            return true;
+        }
+        std::ifstream file(file_path, std::ios::in | std::ios::binary);
+        if (! file.is_open()) {
+            return false;
+        }
+        buffer.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    void close() {
+        if (mapped != NULL) {
+            munmap((void*)mapped, mapped_size);
+            mapped = NULL;
+            mapped_size = 0;
+        }
+        buffer.clear();
+    }
+
+    const char *data() const {
+        return mapped != NULL? mapped : buffer.data();
+    }
+
+    size_t size() const {
+        return mapped != NULL? mapped_size : buffer.size();
+    }
+};
+
+#endif // MAPPED_FILE_H
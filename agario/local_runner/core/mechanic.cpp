@@ -0,0 +1,971 @@
+#include "mechanic.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+
+
+Mechanic::Mechanic(const GameConfig &_config) :
+    config(_config),
+    fixed_physics(find_fixed_physics(config)),
+    tick(0),
+    id_counter(1),
+    logger(new Logger(config)),
+    replay_log(nullptr),
+    replay_verify(false),
+    predator_grid(SPATIAL_CELL_SIZE),
+    vision_tick(-1),
+    food_grid(SPATIAL_CELL_SIZE),
+    eject_grid(SPATIAL_CELL_SIZE),
+    player_grid(SPATIAL_CELL_SIZE),
+    max_player_radius(0),
+    log_detached(false),
+    replay_detached(false)
+{}
+
+Mechanic::~Mechanic() {
+    clear_objects(false);
+    if (logger) delete logger;
+}
+
+template <typename T>
+static void delete_all(std::vector<T*> &objects) {
+    for (T *object : objects) {
+        if (object) delete object;
+    }
+    objects.clear();
+}
+
+// новый объект из освобождённых, если они есть
+template <typename T>
+static T *make_object(std::vector<T*> &spare, const T &value) {
+    if (spare.empty()) {
+        return new T(value);
+    }
+    T *object = spare.back();
+    spare.pop_back();
+    *object = value;
+    return object;
+}
+
+// объект уже убран из массивов мира; память остаётся для make_object
+template <typename T>
+static void recycle_object(std::vector<T*> &spare, T *object) {
+    spare.push_back(object);
+}
+
+void Mechanic::init_objects(const std::string &seed, const StrategyGet &get_strategy) {
+    std::seed_seq seq(seed.begin(), seed.end());
+    rand.seed(seq);
+
+    std::array<unsigned, 1> simple_seeds;
+    seq.generate(simple_seeds.begin(), simple_seeds.end());
+    srand(simple_seeds[0]); // на всякий случай, если вдруг где-то когда-то будет использоваться обычный rand().
+                            // он используется, например, в умолчальной стратегии
+    if (! log_detached) {
+        logger->init_file(std::to_string(simple_seeds[0]), LOG_FILE, false);
+    }
+
+    add_player(START_PLAYER_SETS, get_strategy);
+    add_food(START_FOOD_SETS);
+    add_virus(START_VIRUS_SETS);
+
+    write_base_tick();
+}
+
+void Mechanic::set_replay_log(std::shared_ptr<ReplayLog> replay_log, bool verify) {
+    this->replay_log = replay_log;
+    replay_verify = verify;
+}
+
+void Mechanic::clear_objects(bool with_log) {
+    tick = 0;
+    vision_tick = -1;
+    if (with_log) {
+        logger->clear_file();
+    }
+
+    id_counter = 1;
+    for (Food *food : food_array) {
+        if (food) delete food;
+    }
+    food_array.clear();
+
+    for (Ejection *eject : eject_array) {
+        if (eject) delete eject;
+    }
+    eject_array.clear();
+
+    for (Virus *virus : virus_array) {
+        if (virus) delete virus;
+    }
+    virus_array.clear();
+
+    for (Player *player : player_array) {
+        if (player) delete player;
+    }
+    player_array.clear();
+    player_fragments.clear();
+    max_fragment_ids.clear();
+    for (Strategy *strategy : strategy_array) {
+        if (strategy) delete strategy;
+    }
+    strategy_array.clear();
+
+    delete_all(spare_foods);
+    delete_all(spare_ejections);
+    delete_all(spare_viruses);
+    delete_all(spare_players);
+}
+
+void Mechanic::snapshot(WorldState &state, bool detach) const {
+    state.tick = tick;
+    state.id_counter = id_counter;
+
+    state.foods.clear();
+    for (Food *food : food_array) {
+        state.foods.push_back(*food);
+    }
+    state.ejections.clear();
+    for (Ejection *eject : eject_array) {
+        state.ejections.push_back(*eject);
+    }
+    state.viruses.clear();
+    for (Virus *virus : virus_array) {
+        state.viruses.push_back(*virus);
+    }
+    state.players.clear();
+    for (Player *player : player_array) {
+        state.players.push_back(player->without_debug());
+    }
+
+    state.scores.clear();
+    for (auto &score : player_scores) {
+        state.scores.push_back(score);
+    }
+    state.directs.clear();
+    for (auto &it : strategy_directs) {
+        state.directs.push_back(it);
+    }
+
+    state.rand = rand;
+    state.log_detached = detach || log_detached;
+    state.replay_detached = detach || replay_detached;
+}
+
+// раскладывает значения по объектам массива, забирая их из spare
+template <typename Array, typename T>
+static void restore_objects(Array &objects, std::vector<T*> &spare, const std::vector<T> &values) {
+    spare.insert(spare.end(), objects.begin(), objects.end());
+    objects.clear();
+    for (const T &value : values) {
+        objects.push_back(make_object(spare, value));
+    }
+}
+
+void Mechanic::restore(const WorldState &state) {
+    tick = state.tick;
+    id_counter = state.id_counter;
+
+    restore_objects(food_array, spare_foods, state.foods);
+    restore_objects(eject_array, spare_ejections, state.ejections);
+    restore_objects(virus_array, spare_viruses, state.viruses);
+    restore_objects(player_array, spare_players, state.players);
+    rebuild_fragments_index();
+
+    // ключи счёта не удаляются по ходу игры, поэтому узлы map переиспользуются
+    for (auto &score : state.scores) {
+        player_scores[score.first] = score.second;
+    }
+    for (auto it = player_scores.begin(); it != player_scores.end(); ) {
+        auto found = std::lower_bound(state.scores.begin(), state.scores.end(), *it,
+                                      [] (const std::pair<int, int> &lhs, const std::pair<int, int> &rhs) {
+            return lhs.first < rhs.first;
+        });
+        if (found == state.scores.end() || found->first != it->first) {
+            it = player_scores.erase(it);
+        } else {
+            it++;
+        }
+    }
+    strategy_directs.assign(state.directs.begin(), state.directs.end());
+
+    rand = state.rand;
+    log_detached = state.log_detached;
+    replay_detached = state.replay_detached;
+    vision_tick = -1;
+}
+
+int Mechanic::tickEvent(bool& is_paused) {
+    if (! log_detached) {
+        old_scores.assign(player_scores.begin(), player_scores.end());
+    }
+    if (! strategy_array.empty()) {
+        apply_strategies(tick, is_paused);
+    }
+    tick++;
+    move_moveables();
+    player_ejects();
+    player_splits();
+
+    if (tick % SHRINK_EVERY_TICK == 0) {
+        shrink_players();
+    }
+    eat_all();
+    fuse_players();
+    burst_on_viruses();
+
+    update_players_radius();
+
+    if (! log_detached) {
+        // оба массива упорядочены по id игрока; нового игрока считаем со счётом 0
+        auto old = old_scores.begin();
+        for (auto &score : player_scores) {
+            while (old != old_scores.end() && old->first < score.first) {
+                old++;
+            }
+            int old_score = (old != old_scores.end() && old->first == score.first)? old->second : 0;
+            if (old_score != score.second) {
+                logger->write_player_score(tick, score.first, score.second);
+            }
+        }
+    }
+
+    split_viruses();
+
+    if (tick % ADD_FOOD_DELAY == 0 && food_array.size() < MAX_GAME_FOOD) {
+        add_food(ADD_FOOD_SETS);
+    }
+    if (tick % ADD_VIRUS_DELAY == 0 && virus_array.size() < MAX_GAME_VIRUS) {
+        add_virus(ADD_VIRUS_SETS);
+    }
+    if (tick % config.BASE_TICK == 0) {
+        write_base_tick();
+    }
+    strategy_directs.clear();
+    return tick;
+}
+
+bool Mechanic::known() const {
+    if (player_fragments.empty()) {
+        return true;
+    }
+    else if (player_fragments.size() == 1) {
+        int living_id = player_fragments.begin()->first;
+        int living_score = get_score_for(living_id);
+        for (auto &score : player_scores) {
+            if (score.first != living_id && score.second >= living_score) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void Mechanic::write_base_tick() {
+    if (log_detached) {
+        return;
+    }
+    for (Food *food : food_array) {
+        logger->write_add_cmd(tick, food);
+    }
+    for (Ejection *eject : eject_array) {
+        logger->write_add_cmd(tick, eject);
+    }
+    for (Virus *virus : virus_array) {
+        logger->write_add_cmd(tick, virus);
+    }
+    for (Player *player : player_array) {
+        logger->write_add_cmd(tick, player);
+    }
+    for (auto &score : player_scores) {
+        logger->write_player_score(tick, score.first, score.second);
+    }
+}
+
+bool Mechanic::is_space_empty(double _x, double _y, double _radius) const {
+    for (Player *player : player_array) {
+        if (player->is_intersected(_x, _y, _radius)) {
+            return false;
+        }
+    }
+    for (Virus *virus : virus_array) {
+        if (virus->is_intersected(_x, _y, _radius)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Точка появления - целое плюс 2 * one_radius или её отражение от центра
+// (см. add_circular). Текст лога и блок тика 0 двоичного лога хранят её с
+// %.16g, что double не восстанавливает; при проверке повтора координата
+// пересчитывается по той же формуле.
+static double spawn_coordinate(double logged, double one_radius, double center) {
+    const double eps = 1e-6;
+    double direct = std::round(logged - 2 * one_radius) + 2 * one_radius;
+    if (std::fabs(direct - logged) < eps) {
+        return direct;
+    }
+    double mirrored = center + (center - (std::round(2 * center - logged - 2 * one_radius) + 2 * one_radius));
+    if (std::fabs(mirrored - logged) < eps) {
+        return mirrored;
+    }
+    return logged;
+}
+
+void Mechanic::add_circular(const std::string &type, int sets_cnt, double one_radius, const AddFunc &add_one) {
+    if (replay_log != nullptr && ! replay_detached && replay_verify) {
+        double center_x = config.GAME_WIDTH / 2, center_y = config.GAME_HEIGHT / 2;
+        int first_id = id_counter;
+        std::pair<double, double> point;
+        for (int I = 0; I < sets_cnt * 4 && replay_log->find_new_point(tick, type, first_id, point); I++) {
+            add_one(spawn_coordinate(point.first, one_radius, center_x),
+                    spawn_coordinate(point.second, one_radius, center_y));
+        }
+    } else if (replay_log != nullptr && ! replay_detached) {
+        for (int I = 0; I < sets_cnt * 4; I++) {
+            auto point = replay_log->get_point(tick, type);
+            add_one(point.first, point.second);
+        }
+    } else {
+        double center_x = config.GAME_WIDTH / 2, center_y = config.GAME_HEIGHT / 2;
+        for (int I = 0; I < sets_cnt; I++) {
+            double _x = rand() % int(std::ceil(center_x - 4 * one_radius)) + 2 * one_radius;
+            double _y = rand() % int(std::ceil(center_y - 4 * one_radius)) + 2 * one_radius;
+            add_one(_x, _y);
+            add_one(center_x + (center_x - _x), _y);
+            add_one(center_x + (center_x - _x), center_y + (center_y - _y));
+            add_one(_x, center_y + (center_y - _y));
+        }
+    }
+}
+
+void Mechanic::add_food(int sets_cnt) {
+    add_circular("AF", sets_cnt, FOOD_RADIUS, [=] (double _x, double _y) {
+        Food *new_food = make_object(spare_foods, Food(id_counter, _x, _y, FOOD_RADIUS, config.FOOD_MASS));
+        food_array.push_back(new_food);
+        id_counter++;
+        if (tick % config.BASE_TICK != 0 && ! log_detached) {
+            logger->write_add_cmd(tick, new_food);
+        }
+    });
+}
+
+void Mechanic::add_virus(int sets_cnt) {
+    double rad = config.VIRUS_RADIUS;
+    add_circular("AV", sets_cnt, rad, [=] (double _x, double _y) {
+        if (! is_space_empty(_x, _y, rad)) {
+            return;
+        }
+        Virus *new_virus = make_object(spare_viruses, Virus(id_counter, _x, _y, rad, VIRUS_MASS));
+        virus_array.push_back(new_virus);
+        id_counter++;
+        if (tick % config.BASE_TICK != 0 && ! log_detached) {
+            logger->write_add_cmd(tick, new_virus);
+        }
+    });
+}
+
+void Mechanic::add_player(int sets_cnt, const StrategyGet &get_strategy) {
+    add_circular("AP", sets_cnt, PLAYER_RADIUS, [=] (double _x, double _y) {
+        if (! is_space_empty(_x, _y, PLAYER_RADIUS)) {
+            return;
+        }
+        Player *new_player = make_object(spare_players, Player(id_counter, _x, _y, PLAYER_RADIUS, PLAYER_MASS));
+        add_fragment(new_player);
+        new_player->update_by_mass(config);
+
+        // сервер управляет игроками по сети и стратегий не создаёт
+        Strategy *new_strategy = get_strategy(new_player);
+        if (new_strategy != NULL) {
+            strategy_array.push_back(new_strategy);
+        }
+
+        player_scores[id_counter] = 0;
+        id_counter++;
+        if (tick % config.BASE_TICK != 0 && ! log_detached) {
+            logger->write_add_cmd(tick, new_player);
+        }
+    });
+}
+
+PlayerArray Mechanic::get_players_by_id(int pId) const {
+    return fragments_of(pId);
+}
+
+// фрагменты без копирования; ссылка живёт до изменения индекса
+const PlayerArray &Mechanic::fragments_of(int pId) const {
+    static const PlayerArray empty;
+    auto it = player_fragments.find(pId);
+    return it == player_fragments.end()? empty : it->second;
+}
+
+int Mechanic::get_fragments_cnt(int pId) const {
+    auto it = player_fragments.find(pId);
+    return it == player_fragments.end()? 0 : int(it->second.size());
+}
+
+int Mechanic::get_max_fragment_id(int pId) const {
+    auto it = max_fragment_ids.find(pId);
+    return it == max_fragment_ids.end()? 0 : it->second;
+}
+
+void Mechanic::add_fragment(Player *frag) {
+    player_array.push_back(frag);
+    player_fragments[frag->getId()].push_back(frag);
+    update_max_fragment_id(frag->getId());
+}
+
+// удаляет фрагмент из индекса; из player_array его убирает вызывающий
+void Mechanic::remove_fragment(Player *frag) {
+    int pId = frag->getId();
+    PlayerArray &fragments = player_fragments[pId];
+    auto it = std::find(fragments.begin(), fragments.end(), frag);
+    if (it != fragments.end()) {
+        fragments.erase(it);
+    }
+    if (fragments.empty()) {
+        player_fragments.erase(pId);
+        max_fragment_ids.erase(pId);
+    } else {
+        update_max_fragment_id(pId);
+    }
+}
+
+// fragmentId меняется при делении, взрыве и слиянии - пересчитываем по фрагментам игрока
+void Mechanic::update_max_fragment_id(int pId) {
+    int max_fId = 0;
+    for (Player *player : player_fragments[pId]) {
+        if (max_fId < player->get_fId()) {
+            max_fId = player->get_fId();
+        }
+    }
+    max_fragment_ids[pId] = max_fId;
+}
+
+// восстанавливает индекс по player_array, не пересоздавая массивы живых игроков
+void Mechanic::rebuild_fragments_index() {
+    for (auto &it : player_fragments) {
+        it.second.clear();
+    }
+    for (Player *player : player_array) {
+        player_fragments[player->getId()].push_back(player);
+    }
+    for (auto it = player_fragments.begin(); it != player_fragments.end(); ) {
+        if (it->second.empty()) {
+            max_fragment_ids.erase(it->first);
+            it = player_fragments.erase(it);
+        } else {
+            update_max_fragment_id(it->first);
+            it++;
+        }
+    }
+}
+
+Strategy *Mechanic::get_strategy_by_id(int sId) const {
+    for (Strategy *strategy : strategy_array) {
+        if (strategy->getId() == sId) {
+            return strategy;
+        }
+    }
+    return NULL;
+}
+
+// радиусы обзора и сетки целей зависят только от состояния мира после тика,
+// поэтому пересчитываются при первом запросе на тике, а не для каждого клиента
+void Mechanic::update_visions() {
+    // fog of war
+    for (Player *player : player_array) {
+        int frag_cnt = get_fragments_cnt(player->getId());
+        bool updated = player->update_vision(frag_cnt);
+        if (updated && ! log_detached) {
+            logger->write_fog_for(tick, player);
+        }
+    }
+
+    food_grid.reset(config.GAME_WIDTH, config.GAME_HEIGHT);
+    for (int I = 0; I < int(food_array.size()); I++) {
+        food_grid.insert(I, food_array[I]->getX(), food_array[I]->getY());
+    }
+    eject_grid.reset(config.GAME_WIDTH, config.GAME_HEIGHT);
+    for (int I = 0; I < int(eject_array.size()); I++) {
+        eject_grid.insert(I, eject_array.x[I], eject_array.y[I]);
+    }
+    player_grid.reset(config.GAME_WIDTH, config.GAME_HEIGHT);
+    max_player_radius = 0;
+    for (int I = 0; I < int(player_array.size()); I++) {
+        player_grid.insert(I, player_array[I]->getX(), player_array[I]->getY());
+        max_player_radius = std::max(max_player_radius, player_array[I]->getR());
+    }
+    vision_tick = tick;
+}
+
+CircleArray Mechanic::get_visibles(const PlayerArray& for_them) {
+    if (vision_tick != tick) {
+        update_visions();
+    }
+
+    CircleArray visibles;
+    append_visibles(food_array, food_grid, FOOD_RADIUS, for_them, visibles);
+    append_visibles(eject_array.view(), eject_grid, EJECT_RADIUS, for_them, visibles);
+    auto pId = for_them.empty() ? -1 : for_them.front()->getId();
+    append_visibles(player_array, player_grid, max_player_radius, for_them, visibles, pId);
+    for (Virus *virus : virus_array) {
+        visibles.push_back(virus);
+    }
+    return visibles;
+}
+
+template <typename T>
+void Mechanic::append_visibles(const std::vector<T*> &objects, const SpatialGrid<int> &grid, double max_radius,
+                               const PlayerArray &for_them, CircleArray &visibles, int skip_pId) {
+    // центр обзора смещён от центра фрагмента не больше чем на VIS_SHIFT
+    visible_ids.clear();
+    for (Player *fragment : for_them) {
+        double reach = fragment->getVR() + VIS_SHIFT + max_radius;
+        grid.query(fragment->getX(), fragment->getY(), reach, [this] (int index) {
+            visible_ids.push_back(index);
+        });
+    }
+    // сохраняем порядок исходного массива
+    std::sort(visible_ids.begin(), visible_ids.end());
+    visible_ids.erase(std::unique(visible_ids.begin(), visible_ids.end()), visible_ids.end());
+
+    for (int index : visible_ids) {
+        T *object = objects[index];
+        if (object->getId() == skip_pId && object->is_player()) {
+            continue;
+        }
+        for (Player *fragment : for_them) {
+            if (fragment->can_see(object)) {
+                visibles.push_back(object);
+                break;
+            }
+        }
+    }
+}
+
+void Mechanic::apply_strategies(int tick, bool& is_paused) {
+    for (Strategy *strategy : strategy_array) {
+        int sId = strategy->getId();
+        PlayerArray fragments = get_players_by_id(sId);
+        if (fragments.empty()) {
+            continue;
+        }
+        CircleArray visibles = get_visibles(fragments);
+
+        Direct direct = strategy->tickEvent(fragments, visibles);
+        if (direct.pause) {
+            is_paused = true;
+        }
+        if (replay_log != nullptr && ! replay_detached && ! replay_verify) {
+            direct = replay_log->get_command(tick, sId);
+        }
+
+        apply_direct_for(sId, direct);
+    }
+}
+
+void Mechanic::apply_direct_for(int sId, Direct direct) {
+//    logger->write_direct(tick, sId, direct);
+#ifdef FIXED_PHYSICS
+    switch (fixed_physics) {
+#define APPLY_DIRECT_WITH(NAME, ...) \
+    case FIXED_PHYSICS_##NAME: return apply_direct_with(FixedPhysics##NAME(), sId, direct);
+    FIXED_PHYSICS_TABLE(APPLY_DIRECT_WITH)
+#undef APPLY_DIRECT_WITH
+    default: break;
+    }
+#endif
+    apply_direct_with(config, sId, direct);
+}
+
+template <typename Physics>
+void Mechanic::apply_direct_with(const Physics &physics, int sId, const Direct &direct) {
+    for (Player *frag : fragments_of(sId)) {
+        frag->apply_direct(direct, physics);
+        if (! log_detached) {
+            logger->write_direct_for(tick, frag, direct);
+        }
+    }
+
+    auto it = std::lower_bound(strategy_directs.begin(), strategy_directs.end(), sId,
+                               [] (const std::pair<int, Direct> &lhs, int rhs) {
+        return lhs.first < rhs;
+    });
+    if (it != strategy_directs.end() && it->first == sId) {
+        it->second = direct;
+    } else {
+        strategy_directs.insert(it, std::make_pair(sId, direct));
+    }
+}
+
+void Mechanic::split_fragments(const PlayerArray &fragments) {
+    int fragments_count = fragments.size();
+
+    // Сортировка фрагментов по массе. При совпадении массы - по индексу.
+    // Фрагменты с большим значением критерия после сортировки окажутся ближе к началу.
+    // Сортируется копия: add_fragment дописывает в индекс, на который может ссылаться fragments.
+    split_order.assign(fragments.begin(), fragments.end());
+    std::sort(split_order.begin(), split_order.end(), [] (const Player* lhs, const Player* rhs) {
+        return
+            std::make_tuple(lhs->getM(), lhs->get_fId()) >
+            std::make_tuple(rhs->getM(), rhs->get_fId());
+    });
+
+    for (Player *frag : split_order) {
+
+        if (frag->can_split(fragments_count, config)) {
+            int max_fId = get_max_fragment_id(frag->getId());
+            std::string old_id = frag->id_to_str();
+
+            Player *new_frag = make_object(spare_players, frag->split_now(max_fId, config));
+            add_fragment(new_frag);
+            fragments_count++;
+
+            if (! log_detached) {
+                logger->write_add_cmd(tick, new_frag);
+                logger->write_change_mass_id(tick, old_id, frag);
+            }
+        }
+    }
+}
+
+void Mechanic::player_splits() {
+
+    for (auto it = strategy_directs.begin(); it != strategy_directs.end(); it++) {
+        const Direct& direct = it->second;
+
+        if (direct.split) {
+            const int player_id = it->first;
+            split_fragments(fragments_of(player_id));
+        }
+    }
+}
+
+void Mechanic::player_ejects() {
+    for (auto it = strategy_directs.begin(); it != strategy_directs.end(); it++) {
+        int sId = it->first;
+        const Direct &direct = it->second;
+        if(direct.split || !direct.eject) {
+            continue;
+        }
+        for (Player *frag : fragments_of(sId)) {
+            if (frag->can_eject()) {
+                Ejection *new_eject = make_object(spare_ejections, frag->eject_now(id_counter));
+                eject_array.push_back(new_eject);
+                id_counter++;
+
+                if (! log_detached) {
+                    logger->write_add_cmd(tick, new_eject);
+                }
+            }
+        }
+    }
+}
+
+void Mechanic::eat_all() {
+    // съесть добычу может только хищник, в чей радиус попадает её центр,
+    // поэтому кандидатов достаточно взять из ячейки сетки под центром добычи
+    predator_grid.reset(config.GAME_WIDTH, config.GAME_HEIGHT);
+    for (Player *predator : player_array) {
+        predator_grid.insert(predator, predator->getX(), predator->getY(), predator->getR());
+    }
+
+    auto nearest_player = [this] (Circle *circle) {
+        Player *nearest_predator = NULL;
+        double deeper_dist = -INFINITY;
+        for (Player *predator : predator_grid.at(circle->getX(), circle->getY())) {
+            double qdist = predator->can_eat(circle);
+            if (qdist > deeper_dist) {
+                deeper_dist = qdist;
+                nearest_predator = predator;
+            }
+        }
+        return nearest_predator;
+    };
+    auto nearest_virus = [this] (Ejection *eject) {
+        Virus *nearest_predator = NULL;
+        double deeper_dist = -INFINITY;
+        for (Virus *predator : virus_array) {
+            double qdist = predator->can_eat(eject);
+            if (qdist > deeper_dist) {
+                deeper_dist = qdist;
+                nearest_predator = predator;
+            }
+        }
+        return nearest_predator;
+    };
+
+    for (auto fit = food_array.begin(); fit != food_array.end();) {
+        if (Player *eater = nearest_player(*fit)) {
+            eater->eat(*fit);
+            player_scores[eater->getId()] += SCORE_FOR_FOOD;
+            if (! log_detached) {
+                logger->write_kill_cmd(tick, *fit);
+            }
+            recycle_object(spare_foods, *fit);
+            fit = food_array.erase(fit);
+        } else {
+            fit++;
+        }
+    }
+
+    for (auto eit = eject_array.begin(); eit != eject_array.end(); ) {
+        auto eject = *eit;
+        if (Virus *eater = nearest_virus(eject)) {
+            eater->eat(eject);
+        } else if (Player *eater = nearest_player(eject)) {
+            eater->eat(eject);
+            if (!eject->is_my_eject(eater)) {
+                player_scores[eater->getId()] += SCORE_FOR_FOOD;
+            }
+        } else {
+            eit++;
+            continue;
+        }
+
+        if (! log_detached) {
+            logger->write_kill_cmd(tick, eject);
+        }
+        recycle_object(spare_ejections, eject);
+        eit = eject_array.erase(eit);
+    }
+
+    for (auto pit = player_array.begin(); pit != player_array.end(); ) {
+        if(Player *eater = nearest_player(*pit)) {
+            bool is_last = get_fragments_cnt((*pit)->getId()) == 1;
+            eater->eat(*pit);
+            player_scores[eater->getId()] += is_last? SCORE_FOR_LAST : SCORE_FOR_PLAYER;
+            if (! log_detached) {
+                logger->write_kill_cmd(tick, *pit);
+            }
+            predator_grid.remove(*pit, (*pit)->getX(), (*pit)->getY(), (*pit)->getR());
+            remove_fragment(*pit);
+            recycle_object(spare_players, *pit);
+            pit = player_array.erase(pit);
+        } else {
+            pit++;
+        }
+    }
+}
+
+void Mechanic::burst_on_viruses() { // TODO: improve target selection
+    auto nearest_to = [this] (Virus *virus) {
+        double nearest_dist = INFINITY;
+        Player *nearest_player = NULL;
+
+        for (Player *player : player_array) {
+            double qdist = virus->can_hurt(player);
+            if (qdist < nearest_dist) {
+                int yet_cnt = get_fragments_cnt(player->getId());
+                if (player->can_burst(yet_cnt, config)) {
+                    nearest_dist = qdist;
+                    nearest_player = player;
+                }
+            }
+        }
+        return nearest_player;
+    };
+
+
+
+    for (auto vit = virus_array.begin(); vit != virus_array.end(); ) {
+        if (Player *player = nearest_to(*vit)) {
+            int yet_cnt = get_fragments_cnt(player->getId());
+            int max_fId = get_max_fragment_id(player->getId());
+            std::string old_id = player->id_to_str();
+
+            player->burst_on(*vit, config);
+            player_scores[player->getId()] += SCORE_FOR_BURST;
+            player->burst_now(max_fId, yet_cnt, config, burst_values);
+            size_t first_new = player_array.size();
+            for (const Player &value : burst_values) {
+                add_fragment(make_object(spare_players, value));
+            }
+            update_max_fragment_id(player->getId());
+
+            if (! log_detached) {
+                for (size_t I = first_new; I < player_array.size(); I++) {
+                    logger->write_add_cmd(tick, player_array[I]);
+                }
+                logger->write_change_mass_id(tick, old_id, player);
+                logger->write_kill_cmd(tick, *vit);
+            }
+            recycle_object(spare_viruses, *vit);
+            vit = virus_array.erase(vit);
+        } else {
+            vit++;
+        }
+    }
+}
+
+void Mechanic::fuse_players() {
+    // ключи индекса до конца цикла не меняются: слитые фрагменты убираются после
+    fused_players.clear();
+    for (auto &pit : player_fragments) {
+        int id = pit.first;
+        PlayerArray &fragments = fuse_order;
+        fragments.assign(pit.second.begin(), pit.second.end());
+        // приведём в предсказуемый порядок
+        std::sort(fragments.begin(), fragments.end(),
+                  [](const Player *a, const Player *b) -> bool {
+                      if (a->getM() == b->getM()) {
+                          return a->get_fId() < b->get_fId();
+                      } else {
+                          return a->getM() > b->getM();
+                      }
+                  });
+        bool new_fusion_check = true; // проверим всех. Если слияние произошло - перепроверим ещё разок, чтобы все могли слиться в один тик
+        while (new_fusion_check) {
+            new_fusion_check = false;
+            for (auto it = fragments.begin(); it != fragments.end(); ++it) {
+                auto &player = *it;
+                for (auto it2 = std::next(it); it2 != fragments.end(); ) {
+                    auto &frag = *it2;
+                    if (player->can_fuse(frag)) {
+                        player->fusion(frag);
+                        fused_players.push_back(frag);
+                        new_fusion_check = true;
+                        // it стоит раньше it2, erase его не сдвигает
+                        it2 = fragments.erase(it2);
+                    } else {
+                        ++it2;
+                    }
+                }
+            }
+            if (new_fusion_check) {
+                for (auto it = fragments.begin(); it != fragments.end(); ++it) {
+                    bool changed = (*it)->update_by_mass(config); // need for future fusing
+                    if (changed && ! log_detached) {
+                        logger->write_change_mass(tick, *it);
+                    }
+                }
+            }
+        }
+        if (fragments.size() == 1) {
+            Player *player = fragments.front();
+            std::string old_id = player->id_to_str();
+            bool changed = player->clear_fragments();
+            if (changed) {
+                update_max_fragment_id(id);
+                if (! log_detached) {
+                    logger->write_change_id(tick, old_id, player);
+                }
+            }
+            continue;
+        }
+    }
+    for (Player *p : fused_players) {
+        if (! log_detached) {
+            logger->write_kill_cmd(tick, p);
+        }
+        remove_fragment(p);
+        player_array.erase(std::remove(player_array.begin(), player_array.end(), p), player_array.end());
+        recycle_object(spare_players, p);
+    }
+}
+
+void Mechanic::move_moveables() {
+#ifdef FIXED_PHYSICS
+    switch (fixed_physics) {
+#define MOVE_MOVEABLES_WITH(NAME, ...) \
+    case FIXED_PHYSICS_##NAME: return move_moveables_with(FixedPhysics##NAME());
+    FIXED_PHYSICS_TABLE(MOVE_MOVEABLES_WITH)
+#undef MOVE_MOVEABLES_WITH
+    default: break;
+    }
+#endif
+    move_moveables_with(config);
+}
+
+template <typename Physics>
+void Mechanic::move_moveables_with(const Physics &physics) {
+    eject_array.move(physics);
+    virus_array.move(physics);
+    if (! log_detached) {
+        for (size_t I = 0; I < eject_array.size(); I++) {
+            if (eject_array.changed(I)) {
+                logger->write_change_pos(tick, eject_array[I]);
+            }
+        }
+        for (size_t I = 0; I < virus_array.size(); I++) {
+            if (virus_array.changed(I)) {
+                logger->write_change_pos(tick, virus_array[I]);
+            }
+        }
+    }
+
+    for (auto &it : player_fragments) {
+        const PlayerArray &fragments = it.second;
+        for (size_t i = 0; i != fragments.size(); ++i) {
+            Player *curr = fragments[i];
+            for (size_t j = i + 1; j < fragments.size(); ++j) {
+                curr->collisionCalc(fragments[j]);
+            }
+        }
+    }
+
+    for (Player *player : player_array) {
+        bool changed = player->move(physics);
+        if (changed && ! log_detached) {
+            logger->write_change_pos(tick, player);
+        }
+        if (replay_log != nullptr && ! replay_detached && ! replay_verify) {
+            double x, y;
+            if (replay_log->get_player_pos(tick, player->getId(), player->get_fId(), x, y)) {
+                player->x = x;
+                player->y = y;
+            }
+        }
+    }
+}
+
+void Mechanic::update_players_radius() {
+    for (Player *player : player_array) {
+        bool changed = player->update_by_mass(config);
+        if (changed && ! log_detached) {
+            logger->write_change_mass(tick, player);
+        }
+    }
+}
+
+void Mechanic::split_viruses() {
+    new_viruses.clear();
+    for (Virus *virus : virus_array) {
+        if (virus->can_split(config)) {
+            Virus *new_virus = make_object(spare_viruses, virus->split_now(id_counter, config));
+            if (! log_detached) {
+                logger->write_add_cmd(tick, new_virus);
+            }
+            new_viruses.push_back(new_virus);
+            id_counter++;
+        }
+    }
+    for (Virus *new_virus : new_viruses) {
+        virus_array.push_back(new_virus);
+    }
+}
+
+void Mechanic::shrink_players() {
+    for (Player *player : player_array) {
+        if (player->can_shrink()) {
+            player->shrink_now();
+            if (! log_detached) {
+                logger->write_change_mass(tick, player);
+            }
+        }
+    }
+}
+
+int Mechanic::get_score_for(int pId) const {
+    auto it = player_scores.find(pId);
+    return it == player_scores.end()? 0 : it->second;
+}
+
+std::map<int, int> Mechanic::get_scores() const {
+    return player_scores;
+}
@@ -0,0 +1,203 @@
+#ifndef MECHANIC_H
+#define MECHANIC_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fixed_physics.h"
+#include "logger.h"
+#include "motion_array.h"
+#include "replay_log.h"
+#include "spatial_grid.h"
+#include "strategy.h"
+#include "world_state.h"
+#include "entities/food.h"
+#include "entities/virus.h"
+#include "entities/player.h"
+#include "entities/ejection.h"
+
+typedef std::function<void(double, double)> AddFunc;
+typedef std::function<Strategy*(Player*)> StrategyGet;
+
+
+class Mechanic
+{
+private:
+    const GameConfig config;
+    // ядро движения для параметров игры (см. fixed_physics.h)
+    const FixedPhysicsId fixed_physics;
+    int tick;
+    int id_counter;
+    Logger *logger;
+    std::shared_ptr<ReplayLog> replay_log;
+    // повтор для проверки: из лога берутся только точки появления новых
+    // объектов, команды дают стратегии, положения игроков не подменяются
+    bool replay_verify;
+
+    FoodArray food_array;
+    // выбросы и вирусы летают: их координаты и скорость лежат столбцами
+    MotionArray<Ejection> eject_array;
+    MotionArray<Virus> virus_array;
+
+    PlayerArray player_array;
+    // фрагменты каждого игрока в порядке player_array и их максимальный fragmentId
+    std::map<int, PlayerArray> player_fragments;
+    std::map<int, int> max_fragment_ids;
+    StrategyArray strategy_array;
+    // команды тика по возрастанию id игрока; вектор, а не map, чтобы очистка
+    // между тиками не освобождала память под команды
+    std::vector<std::pair<int, Direct>> strategy_directs;
+    std::map<int, int> player_scores;
+    // счёт до тика, для лога изменений
+    std::vector<std::pair<int, int>> old_scores;
+
+    SpatialGrid<Player*> predator_grid;
+
+    // индексы объектов в массивах на момент vision_tick; строятся один раз за тик
+    int vision_tick;
+    SpatialGrid<int> food_grid;
+    SpatialGrid<int> eject_grid;
+    SpatialGrid<int> player_grid;
+    double max_player_radius;
+    std::vector<int> visible_ids;
+
+    std::mt19937_64 rand;
+
+    // форк для перебора не пишет лог и не читает реплей (см. snapshot)
+    bool log_detached;
+    bool replay_detached;
+
+    // Объекты, съеденные по ходу игры или освобождённые при restore. Новые
+    // объекты берутся отсюда (см. make_object), так что прогретый форк
+    // шагает без выделения памяти.
+    FoodArray spare_foods;
+    EjectionArray spare_ejections;
+    VirusArray spare_viruses;
+    PlayerArray spare_players;
+
+    // рабочие массивы тика, память переиспользуется между тиками
+    PlayerArray split_order;
+    std::vector<Player> burst_values;
+    PlayerArray fuse_order;
+    PlayerArray fused_players;
+    VirusArray new_viruses;
+
+public:
+    explicit Mechanic(const GameConfig &_config);
+    virtual ~Mechanic();
+
+public:
+    void init_objects(const std::string &seed, const StrategyGet &get_strategy);
+    void set_replay_log(std::shared_ptr<ReplayLog> replay_log, bool verify=false);
+    void clear_objects(bool with_log=true);
+
+    // Копирует состояние мира в state, переиспользуя его память. С detach=true
+    // восстановленный из state форк не пишет лог и не трогает реплей.
+    void snapshot(WorldState &state, bool detach=true) const;
+    // Возвращает мир в состояние state. Объекты переиспользуются, поэтому при
+    // прогретых буферах и том же наборе живых игроков restore не выделяет память.
+    // Отладочный вывод стратегий в снапшот не попадает.
+    void restore(const WorldState &state);
+
+    // стратегии опрашиваются, только если они были созданы в init_objects (локальный раннер)
+    int tickEvent(bool& is_paused);
+    bool known() const;
+
+public:
+    void write_base_tick();
+
+    const GameConfig &get_config() const {
+        return config;
+    }
+
+    Logger *get_logger() const {
+        return logger;
+    }
+
+    // игра без лога, например в пакетном прогоне
+    void set_log_detached(bool detached) {
+        log_detached = detached;
+    }
+
+    int get_tick() const {
+        return tick;
+    }
+
+    const FoodArray &get_foods() const {
+        return food_array;
+    }
+
+    const EjectionArray &get_ejections() const {
+        return eject_array.view();
+    }
+
+    const VirusArray &get_viruses() const {
+        return virus_array.view();
+    }
+
+    const PlayerArray &get_players() const {
+        return player_array;
+    }
+
+    const StrategyArray &get_strategies() const {
+        return strategy_array;
+    }
+
+    bool is_space_empty(double _x, double _y, double _radius) const;
+
+public:
+    void add_circular(const std::string &type, int sets_cnt, double one_radius, const AddFunc &add_one);
+    void add_food(int sets_cnt);
+    void add_virus(int sets_cnt);
+    void add_player(int sets_cnt, const StrategyGet &get_strategy);
+
+public:
+    PlayerArray get_players_by_id(int pId) const;
+    int get_fragments_cnt(int pId) const;
+    int get_max_fragment_id(int pId) const;
+
+    void add_fragment(Player *frag);
+    void remove_fragment(Player *frag);
+    void update_max_fragment_id(int pId);
+    void rebuild_fragments_index();
+
+    Strategy *get_strategy_by_id(int sId) const;
+
+    void update_visions();
+    CircleArray get_visibles(const PlayerArray& for_them);
+
+public:
+    void apply_strategies(int tick, bool& is_paused);
+    void apply_direct_for(int sId, Direct direct);
+    void split_fragments(const PlayerArray &fragments);
+    void player_splits();
+    void player_ejects();
+    void eat_all();
+    void burst_on_viruses();
+    void fuse_players();
+    void move_moveables();
+    void update_players_radius();
+    void split_viruses();
+    void shrink_players();
+
+    int get_score_for(int pId) const;
+    std::map<int, int> get_scores() const;
+
+private:
+    const PlayerArray &fragments_of(int pId) const;
+
+    template <typename Physics>
+    void apply_direct_with(const Physics &physics, int sId, const Direct &direct);
+    template <typename Physics>
+    void move_moveables_with(const Physics &physics);
+
+    template <typename T>
+    void append_visibles(const std::vector<T*> &objects, const SpatialGrid<int> &grid, double max_radius,
+                         const PlayerArray &for_them, CircleArray &visibles, int skip_pId=-1);
+};
+
+#endif // MECHANIC_H
@@ -0,0 +1,118 @@
+#ifndef MOTION_ARRAY_H
+#define MOTION_ARRAY_H
+
+#include "entities/circle.h"
+#include "motion_kernels.h"
+
+#include <vector>
+
+
+// Массив движущихся объектов одного вида (выбросы, вирусы). Кинематика лежит
+// в отдельных столбцах по индексу объекта, поэтому шаг движения идёт подряд по
+// памяти, без переходов по указателям. Порядок столбцов совпадает с порядком
+// объектов, так что лог пишется в прежнем порядке; сами объекты остаются
+// устойчивыми ссылками для логгера, стратегий и снапшотов.
+//
+// Столбцы - рабочая копия полей объекта: после move() полетевшие объекты
+// получают новые координаты и скорость, так что объект и столбцы не расходятся.
+// Угол после set_impulse не меняется, поэтому направление (dir_x, dir_y)
+// считается один раз при добавлении объекта.
+template <typename T>
+class MotionArray
+{
+public:
+    typedef typename std::vector<T*>::const_iterator const_iterator;
+
+    std::vector<double> x, y, radius;
+    std::vector<double> speed, angle;
+    std::vector<double> dir_x, dir_y;
+
+private:
+    std::vector<T*> objects;
+    // после move(): MOTION_MOVING и MOTION_CHANGED из motion_kernels.h
+    std::vector<unsigned char> state;
+
+public:
+    const std::vector<T*> &view() const {
+        return objects;
+    }
+
+    size_t size() const {
+        return objects.size();
+    }
+
+    bool empty() const {
+        return objects.empty();
+    }
+
+    T *operator[](size_t index) const {
+        return objects[index];
+    }
+
+    const_iterator begin() const {
+        return objects.begin();
+    }
+
+    const_iterator end() const {
+        return objects.end();
+    }
+
+    void push_back(T *object) {
+        objects.push_back(object);
+        x.push_back(object->getX());
+        y.push_back(object->getY());
+        radius.push_back(object->getR());
+        speed.push_back(object->get_speed());
+        angle.push_back(object->get_angle());
+        dir_x.push_back(std::cos(object->get_angle()));
+        dir_y.push_back(std::sin(object->get_angle()));
+        state.push_back(0);
+    }
+
+    const_iterator erase(const_iterator it) {
+        size_t index = it - objects.begin();
+        x.erase(x.begin() + index);
+        y.erase(y.begin() + index);
+        radius.erase(radius.begin() + index);
+        speed.erase(speed.begin() + index);
+        angle.erase(angle.begin() + index);
+        dir_x.erase(dir_x.begin() + index);
+        dir_y.erase(dir_y.begin() + index);
+        state.erase(state.begin() + index);
+        return objects.erase(it);
+    }
+
+    void clear() {
+        objects.clear();
+        x.clear(); y.clear(); radius.clear();
+        speed.clear(); angle.clear();
+        dir_x.clear(); dir_y.clear();
+        state.clear();
+    }
+
+    template <typename Config>
+    void move(const Config &config) {
+        const size_t count = objects.size();
+        if (count == 0) {
+            return;
+        }
+        MotionLimits limits = {double(config.GAME_WIDTH), double(config.GAME_HEIGHT), config.VISCOSITY};
+        move_columns(count, &x[0], &y[0], &radius[0], &speed[0], &dir_x[0], &dir_y[0], &state[0], limits);
+
+        for (size_t I = 0; I < count; I++) {
+            if (state[I] & MOTION_MOVING) {
+                T *object = objects[I];
+                object->x = x[I];
+                object->y = y[I];
+                object->set_impulse(speed[I], angle[I]);
+            }
+        }
+    }
+
+    // сдвинулся ли объект на последнем move()
+    bool changed(size_t index) const {
+        return (state[index] & MOTION_CHANGED) != 0;
+    }
+};
+
+#endif // MOTION_ARRAY_H
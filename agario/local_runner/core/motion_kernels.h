@@ -0,0 +1,132 @@
+#ifndef MOTION_KERNELS_H
+#define MOTION_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+// Шаг полёта выбросов и вирусов по столбцам MotionArray. Направление полёта
+// (dir_x, dir_y) = (cos, sin) угла считается один раз при set_impulse, поэтому
+// в цикле нет тригонометрии. Векторные версии (AVX - по 4, SSE2 - по 2
+// объекта) выбираются при сборке и считают те же операции в том же порядке,
+// что и скалярная step_motion, так что результат совпадает до бита. Других
+// реализаций полёта нет: сами объекты Ejection и Virus не двигаются.
+//
+// state[I]: MOTION_MOVING - объект летел, MOTION_CHANGED - сдвинулся.
+
+enum {
+    MOTION_MOVING = 1,
+    MOTION_CHANGED = 2
+};
+
+struct MotionLimits {
+    double max_x, max_y;
+    double viscosity;
+};
+
+inline unsigned char step_motion(double &x, double &y, double radius, double &speed,
+                                 double dir_x, double dir_y, const MotionLimits &limits) {
+    if (speed == 0.0) {
+        return 0;
+    }
+    double dx = speed * dir_x;
+    double dy = speed * dir_y;
+
+    double new_x = std::max(radius, std::min(limits.max_x - radius, x + dx));
+    bool changed = (x != new_x);
+    x = new_x;
+
+    double new_y = std::max(radius, std::min(limits.max_y - radius, y + dy));
+    changed |= (y != new_y);
+    y = new_y;
+
+    speed = std::max(0.0, speed - limits.viscosity);
+    return changed? (MOTION_MOVING | MOTION_CHANGED) : MOTION_MOVING;
+}
+
+inline void move_columns(size_t count, double *x, double *y, const double *radius, double *speed,
+                         const double *dir_x, const double *dir_y, unsigned char *state,
+                         const MotionLimits &limits) {
+    size_t I = 0;
+#if defined(__AVX__)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d max_x = _mm256_set1_pd(limits.max_x);
+    const __m256d max_y = _mm256_set1_pd(limits.max_y);
+    const __m256d viscosity = _mm256_set1_pd(limits.viscosity);
+    for (; I + 4 <= count; I += 4) {
+        __m256d s = _mm256_loadu_pd(speed + I);
+        __m256d moving = _mm256_cmp_pd(s, zero, _CMP_NEQ_UQ);
+        int moving_bits = _mm256_movemask_pd(moving);
+        if (moving_bits == 0) {
+            state[I] = state[I + 1] = state[I + 2] = state[I + 3] = 0;
+            continue;
+        }
+        __m256d r = _mm256_loadu_pd(radius + I);
+        __m256d old_x = _mm256_loadu_pd(x + I);
+        __m256d old_y = _mm256_loadu_pd(y + I);
+        // std::max(r, std::min(max - r, v)) с тем же выбором операнда при равенстве
+        __m256d new_x = _mm256_add_pd(old_x, _mm256_mul_pd(s, _mm256_loadu_pd(dir_x + I)));
+        new_x = _mm256_max_pd(_mm256_min_pd(new_x, _mm256_sub_pd(max_x, r)), r);
+        __m256d new_y = _mm256_add_pd(old_y, _mm256_mul_pd(s, _mm256_loadu_pd(dir_y + I)));
+        new_y = _mm256_max_pd(_mm256_min_pd(new_y, _mm256_sub_pd(max_y, r)), r);
+        __m256d new_s = _mm256_max_pd(_mm256_sub_pd(s, viscosity), zero);
+
+        __m256d changed = _mm256_or_pd(_mm256_cmp_pd(old_x, new_x, _CMP_NEQ_UQ),
+                                       _mm256_cmp_pd(old_y, new_y, _CMP_NEQ_UQ));
+        int changed_bits = _mm256_movemask_pd(_mm256_and_pd(changed, moving));
+
+        _mm256_storeu_pd(x + I, _mm256_blendv_pd(old_x, new_x, moving));
+        _mm256_storeu_pd(y + I, _mm256_blendv_pd(old_y, new_y, moving));
+        _mm256_storeu_pd(speed + I, _mm256_blendv_pd(s, new_s, moving));
+        for (int lane = 0; lane < 4; lane++) {
+            state[I + lane] = ((moving_bits >> lane) & 1) * MOTION_MOVING
+                            | ((changed_bits >> lane) & 1) * MOTION_CHANGED;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d max_x = _mm_set1_pd(limits.max_x);
+    const __m128d max_y = _mm_set1_pd(limits.max_y);
+    const __m128d viscosity = _mm_set1_pd(limits.viscosity);
+    for (; I + 2 <= count; I += 2) {
+        __m128d s = _mm_loadu_pd(speed + I);
+        __m128d moving = _mm_cmpneq_pd(s, zero);
+        int moving_bits = _mm_movemask_pd(moving);
+        if (moving_bits == 0) {
+            state[I] = state[I + 1] = 0;
+            continue;
+        }
+        __m128d r = _mm_loadu_pd(radius + I);
+        __m128d old_x = _mm_loadu_pd(x + I);
+        __m128d old_y = _mm_loadu_pd(y + I);
+        __m128d new_x = _mm_add_pd(old_x, _mm_mul_pd(s, _mm_loadu_pd(dir_x + I)));
+        new_x = _mm_max_pd(_mm_min_pd(new_x, _mm_sub_pd(max_x, r)), r);
+        __m128d new_y = _mm_add_pd(old_y, _mm_mul_pd(s, _mm_loadu_pd(dir_y + I)));
+        new_y = _mm_max_pd(_mm_min_pd(new_y, _mm_sub_pd(max_y, r)), r);
+        __m128d new_s = _mm_max_pd(_mm_sub_pd(s, viscosity), zero);
+
+        __m128d changed = _mm_or_pd(_mm_cmpneq_pd(old_x, new_x), _mm_cmpneq_pd(old_y, new_y));
+        int changed_bits = _mm_movemask_pd(_mm_and_pd(changed, moving));
+
+        // в SSE2 нет blendv: берём новое значение там, где moving
+        _mm_storeu_pd(x + I, _mm_or_pd(_mm_and_pd(moving, new_x), _mm_andnot_pd(moving, old_x)));
+        _mm_storeu_pd(y + I, _mm_or_pd(_mm_and_pd(moving, new_y), _mm_andnot_pd(moving, old_y)));
+        _mm_storeu_pd(speed + I, _mm_or_pd(_mm_and_pd(moving, new_s), _mm_andnot_pd(moving, s)));
+        for (int lane = 0; lane < 2; lane++) {
+            state[I + lane] = ((moving_bits >> lane) & 1) * MOTION_MOVING
+                            | ((changed_bits >> lane) & 1) * MOTION_CHANGED;
+        }
+    }
+#endif
+    for (; I < count; I++) {
+        state[I] = step_motion(x[I], y[I], radius[I], speed[I], dir_x[I], dir_y[I], limits);
+    }
+}
+
+#endif // MOTION_KERNELS_H
@@ -0,0 +1,745 @@
+#ifndef REPLAY_FORMAT_H
+#define REPLAY_FORMAT_H
+
+#include "log_format.h"
+#include "shared_buffer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+
+enum LogRecordKind {
+    LOG_ADD_FOOD, LOG_ADD_VIRUS, LOG_ADD_PLAYER, LOG_ADD_EJECT,
+    LOG_DIRECT, LOG_DIRECT_FOR, LOG_FOG,
+    LOG_KILL_FOOD, LOG_KILL_PLAYER, LOG_KILL_VIRUS, LOG_KILL_EJECT,
+    LOG_POS_PLAYER, LOG_POS_EJECT, LOG_POS_VIRUS,
+    LOG_MASS, LOG_MASS_ID, LOG_CHANGE_ID,
+    LOG_DEBUG, LOG_SPRITE, LOG_ERROR, LOG_SOLUTION_ID, LOG_SCORE, LOG_RAW,
+    LOG_WIRE_STATE,         // кадр состояния двоичного протокола, в лог - JSON
+    // управление логгером: идут в той же очереди, что и записи
+    LOG_INIT, LOG_CLEAR, LOG_FLUSH, LOG_REWRITE_TICKS, LOG_AUTOFLUSH, LOG_BINARY, LOG_INDEX, LOG_CAPTURE
+};
+
+// тик записи, который логгер подставит сам (write_error без тика и т.п.)
+#define LOG_CURRENT_TICK -1
+
+// Событие лога в том виде, в каком его отдаёт механика: числа и id без
+// форматирования. Строкой становится в append_log_line.
+struct LogRecord
+{
+    int kind;
+    int tick;
+    int id, fragment_id;    // объект; у игрока - id и номер фрагмента
+    int num;                // цвет, игрок выброса, флаги команды, очки
+    double v[5];
+    std::string text, extra;
+    SharedBuffer shared;    // LOG_RAW без копии: текст вместо text; кадр LOG_WIRE_STATE
+};
+
+
+// Строка текстового лога для записи. Для управляющих записей ничего не пишет.
+inline void append_log_line(std::string &out, const LogRecord &record) {
+    LogPlayerId player = {record.id, record.fragment_id};
+    switch (record.kind) {
+    case LOG_ADD_FOOD:
+        append_format(out, "AF{} X{} Y{}\n", record.id, record.v[0], record.v[1]);
+        break;
+    case LOG_ADD_VIRUS:
+        append_format(out, "AV{} X{} Y{}\n", record.id, record.v[0], record.v[1]);
+        break;
+    case LOG_ADD_PLAYER:
+        append_format(out, "AP{} X{} Y{} R{} M{} C{} F{}\n", player,
+                      record.v[0], record.v[1], record.v[2], record.v[3], record.num, record.v[4]);
+        break;
+    case LOG_ADD_EJECT:
+        append_format(out, "AE{} X{} Y{} P{}\n", record.id, record.v[0], record.v[1], record.num);
+        break;
+    case LOG_DIRECT:
+        append_format(out, "C{} X{} Y{}\n", record.id, record.v[0], record.v[1]);
+        break;
+    case LOG_DIRECT_FOR:
+        append_format(out, "C{} X{} Y{}{}\n", player, record.v[0], record.v[1],
+                      record.num == 'S'? " S" : record.num == 'E'? " E" : "");
+        break;
+    case LOG_FOG:
+        append_format(out, "+P{} F{}\n", player, record.v[0]);
+        break;
+    case LOG_KILL_FOOD:
+        append_format(out, "KF{}\n", record.id);
+        break;
+    case LOG_KILL_PLAYER:
+        append_format(out, "KP{}\n", player);
+        break;
+    case LOG_KILL_VIRUS:
+        append_format(out, "KV{}\n", record.id);
+        break;
+    case LOG_KILL_EJECT:
+        append_format(out, "KE{}\n", record.id);
+        break;
+    case LOG_POS_PLAYER:
+        append_format(out, "+P{} X{} Y{} A{} S{}\n", player, record.v[0], record.v[1], record.v[2], record.v[3]);
+        break;
+    case LOG_POS_EJECT:
+        append_format(out, "+E{} X{} Y{} P{} A{} S{}\n", record.id, record.v[0], record.v[1], record.num, record.v[2], record.v[3]);
+        break;
+    case LOG_POS_VIRUS:
+        append_format(out, "+V{} X{} Y{} M{} A{} S{}\n", record.id, record.v[0], record.v[1], record.v[2], record.v[3], record.v[4]);
+        break;
+    case LOG_MASS:
+        append_format(out, "+P{} X{} Y{} R{} M{}\n", player, record.v[0], record.v[1], record.v[2], record.v[3]);
+        break;
+    case LOG_MASS_ID:
+        append_format(out, "+P{} R{} M{} I{}\n", record.text, record.v[0], record.v[1], player);
+        break;
+    case LOG_CHANGE_ID:
+        append_format(out, "+P{} I{}\n", record.text, player);
+        break;
+    case LOG_DEBUG:
+        append_format(out, "D{} M\"{}\"\n", record.id, LogEscaped{record.text});
+        break;
+    case LOG_SPRITE:
+        append_format(out, "S{} I{} M\"{}\"\n", record.id, record.text, LogEscaped{record.extra});
+        break;
+    case LOG_ERROR:
+        append_format(out, "E{} M\"{}\"\n", record.id, LogEscaped{record.text});
+        break;
+    case LOG_SOLUTION_ID:
+        append_format(out, "OI{} S{}\n", record.id, record.text);
+        break;
+    case LOG_SCORE:
+        append_format(out, "P{} C{}\n", record.id, record.num);
+        break;
+    case LOG_RAW:
+        out += record.shared? *record.shared : record.text;
+        break;
+    }
+}
+
+// метка тика в текстовом логе
+inline void append_tick_line(std::string &out, int tick) {
+    append_format(out, "\nT{}\n", tick);
+}
+
+
+// Разбор строки текстового лога (без перевода строки) в запись. Разбираются
+// только строки событий механики; сообщения стратегий, заголовок и всё
+// незнакомое остаётся текстом. Запись принимается, только если
+// append_log_line даёт из неё ту же строку, так что обратное преобразование
+// всегда без потерь.
+class LogLineParser
+{
+private:
+    const char *p;
+
+    bool literal(const char *text) {
+        size_t size = std::strlen(text);
+        if (std::strncmp(p, text, size) != 0) {
+            return false;
+        }
+        p += size;
+        return true;
+    }
+
+    bool integer(int &value) {
+        char *end;
+        long result = std::strtol(p, &end, 10);
+        if (end == p) {
+            return false;
+        }
+        value = int(result);
+        p = end;
+        return true;
+    }
+
+    bool number(double &value) {
+        char *end;
+        value = std::strtod(p, &end);
+        if (end == p) {
+            return false;
+        }
+        p = end;
+        return true;
+    }
+
+    bool player(LogRecord &record) {
+        record.fragment_id = 0;
+        if (! integer(record.id)) {
+            return false;
+        }
+        return *p != '.' || (++p, integer(record.fragment_id));
+    }
+
+    bool token(std::string &value) {
+        const char *start = p;
+        while (*p != '\0' && *p != ' ') {
+            p++;
+        }
+        value.assign(start, p - start);
+        return p != start;
+    }
+
+    bool parse(LogRecord &record) {
+        if (literal("AF")) {
+            record.kind = LOG_ADD_FOOD;
+            return integer(record.id) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]);
+        }
+        if (literal("AV")) {
+            record.kind = LOG_ADD_VIRUS;
+            return integer(record.id) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]);
+        }
+        if (literal("AP")) {
+            record.kind = LOG_ADD_PLAYER;
+            return player(record) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]) &&
+                    literal(" R") && number(record.v[2]) && literal(" M") && number(record.v[3]) &&
+                    literal(" C") && integer(record.num) && literal(" F") && number(record.v[4]);
+        }
+        if (literal("AE")) {
+            record.kind = LOG_ADD_EJECT;
+            return integer(record.id) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]) &&
+                    literal(" P") && integer(record.num);
+        }
+        if (literal("C")) {
+            record.kind = LOG_DIRECT_FOR;
+            if (! (player(record) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]))) {
+                return false;
+            }
+            record.num = literal(" S")? 'S' : literal(" E")? 'E' : 0;
+            return true;
+        }
+        if (literal("+P")) {
+            const char *id_start = p;
+            if (! token(record.text)) {
+                return false;
+            }
+            if (literal(" I")) {
+                record.kind = LOG_CHANGE_ID;
+                return player(record);
+            }
+            if (literal(" R")) {
+                record.kind = LOG_MASS_ID;
+                return number(record.v[0]) && literal(" M") && number(record.v[1]) && literal(" I") && player(record);
+            }
+            const char *rest = p;
+            p = id_start;
+            if (! player(record) || p != rest) {
+                return false;
+            }
+            if (literal(" F")) {
+                record.kind = LOG_FOG;
+                return number(record.v[0]);
+            }
+            if (! (literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]))) {
+                return false;
+            }
+            if (literal(" A")) {
+                record.kind = LOG_POS_PLAYER;
+                return number(record.v[2]) && literal(" S") && number(record.v[3]);
+            }
+            record.kind = LOG_MASS;
+            return literal(" R") && number(record.v[2]) && literal(" M") && number(record.v[3]);
+        }
+        if (literal("+E")) {
+            record.kind = LOG_POS_EJECT;
+            return integer(record.id) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]) &&
+                    literal(" P") && integer(record.num) && literal(" A") && number(record.v[2]) && literal(" S") && number(record.v[3]);
+        }
+        if (literal("+V")) {
+            record.kind = LOG_POS_VIRUS;
+            return integer(record.id) && literal(" X") && number(record.v[0]) && literal(" Y") && number(record.v[1]) &&
+                    literal(" M") && number(record.v[2]) && literal(" A") && number(record.v[3]) && literal(" S") && number(record.v[4]);
+        }
+        if (literal("KF")) {
+            record.kind = LOG_KILL_FOOD;
+            return integer(record.id);
+        }
+        if (literal("KP")) {
+            record.kind = LOG_KILL_PLAYER;
+            return player(record);
+        }
+        if (literal("KV")) {
+            record.kind = LOG_KILL_VIRUS;
+            return integer(record.id);
+        }
+        if (literal("KE")) {
+            record.kind = LOG_KILL_EJECT;
+            return integer(record.id);
+        }
+        if (literal("P")) {
+            record.kind = LOG_SCORE;
+            return integer(record.id) && literal(" C") && integer(record.num);
+        }
+        return false;
+    }
+
+public:
+    // line - строка без '\n'; check - буфер для проверки
+    bool parse(const std::string &line, LogRecord &record, std::string &check) {
+        p = line.c_str();
+        if (! parse(record) || *p != '\0') {
+            return false;
+        }
+        check.clear();
+        append_log_line(check, record);
+        return check.size() == line.size() + 1 && check.compare(0, line.size(), line) == 0;
+    }
+};
+
+
+// Двоичный формат лога (версия 1). Те же события, что в текстовом логе:
+//   заголовок: "AGRB", версия, флаги (REPLAY_FLOAT32)
+//   событие:   байт-код, затем поля
+//     REPLAY_TICK  - номер тика, разность с предыдущим (zigzag varint)
+//     REPLAY_TEXT  - кусок текстового лога как есть: длина (varint) и байты
+//     REPLAY_KEYFRAME - сброс предыдущих значений полей: с него можно начать
+//                    чтение с середины файла (индекс ключевых кадров)
+//     LogRecordKind - запись механики, поля по replay_fields()
+// id и номера - разность с тем же полем предыдущей записи того же вида
+// (zigzag varint), числа - XOR с тем же полем предыдущей записи того же вида:
+// байт (нулевых младших байт << 4 | значащих байт) и значащие байты; 0 - без
+// изменений. С REPLAY_FLOAT32 координаты X, Y хранятся во float, текст из
+// такого лога уже не совпадает с исходным.
+#define REPLAY_MAGIC "AGRB"
+#define REPLAY_VERSION 1
+#define REPLAY_FLOAT32 1
+
+enum {
+    REPLAY_TICK = 0xF0,
+    REPLAY_TEXT = 0xF1,
+    REPLAY_KEYFRAME = 0xF2
+};
+
+// длина заголовка двоичного лога
+#define REPLAY_HEADER_SIZE 6
+
+enum {
+    REPLAY_FIELD_FID = 1,       // номер фрагмента
+    REPLAY_FIELD_NUM = 2,       // record.num
+    REPLAY_FIELD_TEXT = 4,      // record.text (старый id)
+    REPLAY_FIELD_POS = 8        // v[0], v[1] - координаты
+};
+
+struct ReplayFields
+{
+    int flags;
+    int numbers;    // сколько v[] используется
+};
+
+// поля записи в двоичном логе; numbers < 0 - пишется текстом
+inline ReplayFields replay_fields(int kind) {
+    const int FID = REPLAY_FIELD_FID, NUM = REPLAY_FIELD_NUM, TEXT = REPLAY_FIELD_TEXT, POS = REPLAY_FIELD_POS;
+    switch (kind) {
+    case LOG_ADD_FOOD:      return ReplayFields{POS, 2};
+    case LOG_ADD_VIRUS:     return ReplayFields{POS, 2};
+    case LOG_ADD_PLAYER:    return ReplayFields{FID | NUM | POS, 5};
+    case LOG_ADD_EJECT:     return ReplayFields{NUM | POS, 2};
+    case LOG_DIRECT:        return ReplayFields{POS, 2};
+    case LOG_DIRECT_FOR:    return ReplayFields{FID | NUM | POS, 2};
+    case LOG_FOG:           return ReplayFields{FID, 1};
+    case LOG_KILL_FOOD:     return ReplayFields{0, 0};
+    case LOG_KILL_PLAYER:   return ReplayFields{FID, 0};
+    case LOG_KILL_VIRUS:    return ReplayFields{0, 0};
+    case LOG_KILL_EJECT:    return ReplayFields{0, 0};
+    case LOG_POS_PLAYER:    return ReplayFields{FID | POS, 4};
+    case LOG_POS_EJECT:     return ReplayFields{NUM | POS, 4};
+    case LOG_POS_VIRUS:     return ReplayFields{POS, 5};
+    case LOG_MASS:          return ReplayFields{FID | POS, 4};
+    case LOG_MASS_ID:       return ReplayFields{FID | TEXT, 2};
+    case LOG_CHANGE_ID:     return ReplayFields{FID | TEXT, 0};
+    case LOG_SCORE:         return ReplayFields{NUM, 0};
+    }
+    return ReplayFields{0, -1};
+}
+
+// предыдущие значения полей по видам записей: общие для записи и чтения
+struct ReplayState
+{
+    int tick;
+    int id[LOG_RAW], fragment_id[LOG_RAW], num[LOG_RAW];
+    uint64_t v[LOG_RAW][5];
+
+    void reset() {
+        tick = 0;
+        std::memset(id, 0, sizeof(id));
+        std::memset(fragment_id, 0, sizeof(fragment_id));
+        std::memset(num, 0, sizeof(num));
+        std::memset(v, 0, sizeof(v));
+    }
+};
+
+
+class BinaryLogWriter
+{
+private:
+    bool float32;
+    ReplayState state;
+
+    static void put_varint(std::string &out, uint64_t value) {
+        while (value >= 0x80) {
+            out += char(value | 0x80);
+            value >>= 7;
+        }
+        out += char(value);
+    }
+
+    static void put_signed(std::string &out, int64_t value) {
+        put_varint(out, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+    }
+
+    static void put_bits(std::string &out, uint64_t bits, int size) {
+        if (bits == 0) {
+            out += char(0);
+            return;
+        }
+        int low = 0;
+        while (((bits >> (8 * low)) & 0xFF) == 0) {
+            low++;
+        }
+        int high = size;
+        while (((bits >> (8 * (high - 1))) & 0xFF) == 0) {
+            high--;
+        }
+        out += char(low << 4 | (high - low));
+        for (int I = low; I < high; I++) {
+            out += char(bits >> (8 * I));
+        }
+    }
+
+    static void put_delta(std::string &out, int value, int &previous) {
+        put_signed(out, int64_t(value) - previous);
+        previous = value;
+    }
+
+public:
+    explicit BinaryLogWriter(bool _float32=false) :
+        float32(_float32)
+    {
+        state.reset();
+    }
+
+    // начать новый лог с теми же настройками
+    void reset() {
+        state.reset();
+    }
+
+    // заголовок файла; состояние полей не трогает
+    void begin(std::string &out) const {
+        out += REPLAY_MAGIC;
+        out += char(REPLAY_VERSION);
+        out += char(float32? REPLAY_FLOAT32 : 0);
+    }
+
+    void keyframe(std::string &out) {
+        out += char(REPLAY_KEYFRAME);
+        state.reset();
+    }
+
+    void tick(std::string &out, int tick) {
+        out += char(REPLAY_TICK);
+        put_signed(out, int64_t(tick) - state.tick);
+        state.tick = tick;
+    }
+
+    void text(std::string &out, const char *data, size_t size) {
+        out += char(REPLAY_TEXT);
+        put_varint(out, size);
+        out.append(data, size);
+    }
+
+    // false - запись не из событий механики, её нужно писать текстом
+    bool record(std::string &out, const LogRecord &record) {
+        ReplayFields fields = replay_fields(record.kind);
+        if (fields.numbers < 0) {
+            return false;
+        }
+        int kind = record.kind;
+        out += char(kind);
+        put_delta(out, record.id, state.id[kind]);
+        if (fields.flags & REPLAY_FIELD_FID) {
+            put_delta(out, record.fragment_id, state.fragment_id[kind]);
+        }
+        if (fields.flags & REPLAY_FIELD_NUM) {
+            put_delta(out, record.num, state.num[kind]);
+        }
+        if (fields.flags & REPLAY_FIELD_TEXT) {
+            put_varint(out, record.text.size());
+            out += record.text;
+        }
+        for (int I = 0; I < fields.numbers; I++) {
+            uint64_t bits;
+            int size = 8;
+            if (float32 && I < 2 && (fields.flags & REPLAY_FIELD_POS)) {
+                float value = float(record.v[I]);
+                uint32_t narrow;
+                std::memcpy(&narrow, &value, sizeof(narrow));
+                bits = narrow;
+                size = 4;
+            } else {
+                std::memcpy(&bits, &record.v[I], sizeof(bits));
+            }
+            put_bits(out, bits ^ state.v[kind][I], size);
+            state.v[kind][I] = bits;
+        }
+        return true;
+    }
+};
+
+
+class BinaryLogReader
+{
+private:
+    const unsigned char *p, *end;
+    bool float32;
+    bool valid;
+    ReplayState state;
+
+    bool get_varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            unsigned char byte = *p++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool get_signed(int64_t &value) {
+        uint64_t raw;
+        if (! get_varint(raw)) {
+            return false;
+        }
+        value = int64_t(raw >> 1) ^ -int64_t(raw & 1);
+        return true;
+    }
+
+    bool get_delta(int &value, int &previous) {
+        int64_t delta;
+        if (! get_signed(delta)) {
+            return false;
+        }
+        value = previous = int(previous + delta);
+        return true;
+    }
+
+    bool get_bits(uint64_t &bits) {
+        if (p >= end) {
+            return false;
+        }
+        int header = *p++;
+        int low = header >> 4, count = header & 0x0F;
+        if (end - p < count) {
+            return false;
+        }
+        bits = 0;
+        for (int I = 0; I < count; I++) {
+            bits |= uint64_t(*p++) << (8 * (low + I));
+        }
+        return true;
+    }
+
+public:
+    enum Event {
+        EVENT_END, EVENT_ERROR, EVENT_TICK, EVENT_TEXT, EVENT_RECORD
+    };
+
+    BinaryLogReader(const char *data, size_t size) :
+        p((const unsigned char*)data),
+        end((const unsigned char*)data + size),
+        float32(false),
+        valid(false)
+    {
+        state.reset();
+        if (is_binary(data, size) && (unsigned char)data[4] == REPLAY_VERSION) {
+            float32 = (data[5] & REPLAY_FLOAT32) != 0;
+            valid = true;
+            p += REPLAY_HEADER_SIZE;
+        }
+    }
+
+    // кусок лога без заголовка, начиная с ключевого кадра
+    BinaryLogReader(const char *data, size_t size, bool _float32) :
+        p((const unsigned char*)data),
+        end((const unsigned char*)data + size),
+        float32(_float32),
+        valid(true)
+    {
+        state.reset();
+    }
+
+    static bool is_binary(const char *data, size_t size) {
+        return size >= REPLAY_HEADER_SIZE && std::memcmp(data, REPLAY_MAGIC, 4) == 0;
+    }
+
+    bool is_valid() const {
+        return valid;
+    }
+
+    bool is_float32() const {
+        return float32;
+    }
+
+    // EVENT_TICK - номер в tick, EVENT_TEXT - кусок текста в record.text,
+    // EVENT_RECORD - запись механики
+    Event next(LogRecord &record, int &tick) {
+        if (! valid) {
+            return EVENT_ERROR;
+        }
+        int code = REPLAY_KEYFRAME;
+        while (code == REPLAY_KEYFRAME) {
+            if (p == end) {
+                return EVENT_END;
+            }
+            code = *p++;
+            if (code == REPLAY_KEYFRAME) {
+                state.reset();
+            }
+        }
+        if (code == REPLAY_TICK) {
+            int64_t delta;
+            if (! get_signed(delta)) {
+                return EVENT_ERROR;
+            }
+            tick = state.tick = int(state.tick + delta);
+            return EVENT_TICK;
+        }
+        if (code == REPLAY_TEXT) {
+            uint64_t size;
+            if (! get_varint(size) || uint64_t(end - p) < size) {
+                return EVENT_ERROR;
+            }
+            record.kind = LOG_RAW;
+            record.text.assign((const char*)p, size);
+            p += size;
+            return EVENT_TEXT;
+        }
+        ReplayFields fields = replay_fields(code);
+        if (code >= LOG_RAW || fields.numbers < 0) {
+            return EVENT_ERROR;
+        }
+        record.kind = code;
+        record.tick = state.tick;
+        record.fragment_id = 0;
+        record.num = 0;
+        if (! get_delta(record.id, state.id[code])) {
+            return EVENT_ERROR;
+        }
+        if ((fields.flags & REPLAY_FIELD_FID) && ! get_delta(record.fragment_id, state.fragment_id[code])) {
+            return EVENT_ERROR;
+        }
+        if ((fields.flags & REPLAY_FIELD_NUM) && ! get_delta(record.num, state.num[code])) {
+            return EVENT_ERROR;
+        }
+        if (fields.flags & REPLAY_FIELD_TEXT) {
+            uint64_t size;
+            if (! get_varint(size) || uint64_t(end - p) < size) {
+                return EVENT_ERROR;
+            }
+            record.text.assign((const char*)p, size);
+            p += size;
+        }
+        for (int I = 0; I < fields.numbers; I++) {
+            uint64_t bits;
+            if (! get_bits(bits)) {
+                return EVENT_ERROR;
+            }
+            bits ^= state.v[code][I];
+            state.v[code][I] = bits;
+            if (float32 && I < 2 && (fields.flags & REPLAY_FIELD_POS)) {
+                uint32_t narrow = uint32_t(bits);
+                float value;
+                std::memcpy(&value, &narrow, sizeof(value));
+                record.v[I] = value;
+            } else {
+                std::memcpy(&record.v[I], &bits, sizeof(bits));
+            }
+        }
+        return EVENT_RECORD;
+    }
+};
+
+
+// дописывает в out текст всех оставшихся событий reader; false - данные повреждены
+inline bool binary_events_to_text(BinaryLogReader &reader, std::string &out) {
+    LogRecord record;
+    int tick;
+    while (true) {
+        switch (reader.next(record, tick)) {
+        case BinaryLogReader::EVENT_END:
+            return true;
+        case BinaryLogReader::EVENT_ERROR:
+            return false;
+        case BinaryLogReader::EVENT_TICK:
+            append_tick_line(out, tick);
+            break;
+        case BinaryLogReader::EVENT_TEXT:
+        case BinaryLogReader::EVENT_RECORD:
+            append_log_line(out, record);
+            break;
+        }
+    }
+}
+
+// Текстовый лог из двоичного; false - файл повреждён
+inline bool binary_log_to_text(const char *data, size_t size, std::string &out) {
+    BinaryLogReader reader(data, size);
+    return binary_events_to_text(reader, out);
+}
+
+// Двоичный лог из текстового. Строки, которые не разбираются в запись без
+// потерь, и метки тиков не в своём виде сохраняются текстом.
+inline void text_log_to_binary(const std::string &text, std::string &out, bool float32=false) {
+    BinaryLogWriter writer(float32);
+    LogLineParser parser;
+    LogRecord record;
+    std::string line, check;
+    writer.begin(out);
+
+    size_t pos = 0, text_start = 0;
+    while (pos < text.size()) {
+        size_t line_end = text.find('\n', pos);
+        if (line_end == std::string::npos) {
+            break;
+        }
+        line.assign(text, pos, line_end - pos);
+        size_t next = line_end + 1;
+        int tick;
+        bool is_record = false, is_tick = false;
+        if (line.empty() && next < text.size() && text[next] == 'T') {
+            // "\nT{tick}\n": пустая строка и метка
+            size_t tick_end = text.find('\n', next);
+            if (tick_end != std::string::npos) {
+                char *end;
+                std::string tick_line(text, next + 1, tick_end - next - 1);
+                tick = int(std::strtol(tick_line.c_str(), &end, 10));
+                check.clear();
+                append_tick_line(check, tick);
+                if (*end == '\0' && ! tick_line.empty() && check.compare(0, std::string::npos, text, pos, tick_end + 1 - pos) == 0) {
+                    is_tick = true;
+                    next = tick_end + 1;
+                }
+            }
+        } else {
+            is_record = parser.parse(line, record, check);
+        }
+        if (is_tick || is_record) {
+            if (text_start < pos) {
+                writer.text(out, text.data() + text_start, pos - text_start);
+            }
+            if (is_tick) {
+                writer.tick(out, tick);
+            } else {
+                writer.record(out, record);
+            }
+            text_start = next;
+        }
+        pos = next;
+    }
+    if (text_start < text.size()) {
+        writer.text(out, text.data() + text_start, text.size() - text_start);
+    }
+}
+
+#endif // REPLAY_FORMAT_H
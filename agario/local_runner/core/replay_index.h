@@ -0,0 +1,404 @@
+#ifndef REPLAY_INDEX_H
+#define REPLAY_INDEX_H
+
+#include "replay_format.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "zlib.h"
+
+// размер куска, которым читается и распаковывается файл
+#define REPLAY_READ_CHUNK 65536
+
+
+// Индекс ключевых кадров лога (path + ".idx", пишет Logger с set_index).
+// Ключевой кадр - начало каждого базового тика (tick % BASE_TICK == 0):
+// смещение его метки "\nT{tick}\n" в тексте лога и в двоичном логе, где
+// перед ней стоит REPLAY_KEYFRAME. В .gz тело лога - один deflate-поток, в
+// котором время от времени стоит полный сброс (Z_FULL_FLUSH): с него можно
+// распаковывать без предыдущих данных. Кадр ссылается на последний такой
+// сброс до себя: gz_offset - его место в .gz, gz_log_offset - соответствующее
+// место в тексте. Распаковав от него log_offset - gz_log_offset байт, попадаем
+// на кадр.
+//
+// Формат текстовый: строка-комментарий, строка B{BASE_TICK}, затем по строке
+// на кадр "tick log_offset gz_offset gz_log_offset bin_offset". Первый кадр -
+// тик 0, все смещения 0 (начало файлов). gz_offset 0 - распаковывать с начала
+// .gz, bin_offset -1 - двоичного лога нет.
+
+struct ReplayKeyframe
+{
+    int tick;
+    long long log_offset;
+    long long gz_offset;
+    long long gz_log_offset;
+    long long bin_offset;
+
+    ReplayKeyframe() :
+        tick(0),
+        log_offset(0),
+        gz_offset(0),
+        gz_log_offset(0),
+        bin_offset(0)
+    {}
+};
+
+// путь индекса для лога path, path + ".gz" или path + ".bin"
+inline std::string replay_index_path(const std::string &log_path) {
+    std::string base = log_path;
+    const char *suffixes[] = {".gz", ".bin"};
+    for (const char *suffix : suffixes) {
+        size_t len = std::string(suffix).size();
+        if (base.size() > len && base.compare(base.size() - len, len, suffix) == 0) {
+            base.erase(base.size() - len);
+            break;
+        }
+    }
+    return base + ".idx";
+}
+
+inline bool write_replay_index(const std::string &file_path, int base_tick, const std::vector<ReplayKeyframe> &frames) {
+    std::string out = "# Keyframes: tick log_offset gz_offset gz_log_offset bin_offset\n";
+    append_format(out, "B{}\n", base_tick);
+    for (const ReplayKeyframe &frame : frames) {
+        append_format(out, "{} {} {} {} {}\n", frame.tick, frame.log_offset, frame.gz_offset,
+                      frame.gz_log_offset, frame.bin_offset);
+    }
+    std::ofstream file(file_path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file << out;
+    return file.good();
+}
+
+class ReplayIndex
+{
+private:
+    int base_tick;
+    std::vector<ReplayKeyframe> frames;
+
+public:
+    ReplayIndex() :
+        base_tick(0)
+    {}
+
+    bool load(const std::string &file_path) {
+        base_tick = 0;
+        frames.clear();
+        std::ifstream file(file_path, std::ios::in | std::ios::binary);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            if (line[0] == 'B') {
+                base_tick = std::atoi(line.c_str() + 1);
+                continue;
+            }
+            ReplayKeyframe frame;
+            if (std::sscanf(line.c_str(), "%d %lld %lld %lld %lld", &frame.tick, &frame.log_offset,
+                            &frame.gz_offset, &frame.gz_log_offset, &frame.bin_offset) == 5) {
+                frames.push_back(frame);
+            }
+        }
+        if (base_tick <= 0 || frames.empty() || frames[0].tick != 0) {
+            frames.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool is_loaded() const {
+        return ! frames.empty();
+    }
+
+    int size() const {
+        return frames.size();
+    }
+
+    const ReplayKeyframe &at(int index) const {
+        return frames[index];
+    }
+
+    // номер последнего кадра не позже tick: кадры идут через BASE_TICK, так
+    // что номер вычисляется сразу, цикл нужен только если кадры пропущены
+    int find(int tick) const {
+        if (frames.empty()) {
+            return -1;
+        }
+        int index = tick <= 0? 0 : std::min(tick / base_tick, size() - 1);
+        while (index > 0 && frames[index].tick > tick) {
+            index--;
+        }
+        while (index + 1 < size() && frames[index + 1].tick <= tick) {
+            index++;
+        }
+        return index;
+    }
+};
+
+
+// Построчное чтение лога с произвольного тика. Открывает лог, его .gz или
+// .bin (по имени файла) вместе с индексом; seek(tick) встаёт на ключевой кадр
+// не позже tick, после чего next_line отдаёт строки текста лога начиная с
+// "T{кадр}" - до нужного тика остаётся не больше BASE_TICK тиков. Без индекса
+// seek возможен только на начало.
+class ReplayCursor
+{
+private:
+    enum Source {SOURCE_TEXT, SOURCE_GZIP, SOURCE_BINARY};
+
+    Source source;
+    std::ifstream file;
+    ReplayIndex index;
+    int frame;                  // текущий кадр индекса
+    std::string pending;        // распакованный, но ещё не отданный текст
+    size_t pending_pos;
+    bool finished;
+
+    // .gz
+    std::vector<char> input;
+    z_stream inflater;
+    bool inflating;
+    bool gzip_header;           // распаковка с начала файла, а не с точки сброса
+    long long skip;             // сколько распакованных байт пропустить
+
+    // .bin
+    bool float32;
+    int bin_frame;              // кадр, с которого расшифровывать дальше; -1 - всё
+
+    static bool ends_with(const std::string &text, const char *suffix) {
+        std::string tail(suffix);
+        return text.size() >= tail.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+    }
+
+    void stop_inflating() {
+        if (inflating) {
+            inflateEnd(&inflater);
+            inflating = false;
+        }
+    }
+
+    bool start_inflating(long long offset, bool from_start) {
+        stop_inflating();
+        inflater.zalloc = Z_NULL;
+        inflater.zfree = Z_NULL;
+        inflater.opaque = Z_NULL;
+        inflater.next_in = Z_NULL;
+        inflater.avail_in = 0;
+        if (inflateInit2(&inflater, from_start? 15 | 16 : -15) != Z_OK) {
+            return false;
+        }
+        inflating = true;
+        gzip_header = from_start;
+        file.clear();
+        file.seekg(offset);
+        return file.good();
+    }
+
+    // дописывает в pending следующий кусок текста; false - данные кончились
+    bool fill() {
+        if (finished) {
+            return false;
+        }
+        size_t before = pending.size();
+        if (source == SOURCE_TEXT) {
+            char buffer[REPLAY_READ_CHUNK];
+            file.read(buffer, sizeof(buffer));
+            pending.append(buffer, file.gcount());
+            finished = file.gcount() == 0;
+        } else if (source == SOURCE_GZIP) {
+            fill_gzip();
+        } else {
+            fill_binary();
+        }
+        return ! finished || pending.size() > before;
+    }
+
+    void fill_gzip() {
+        unsigned char output[REPLAY_READ_CHUNK];
+        if (inflater.avail_in == 0) {
+            input.resize(REPLAY_READ_CHUNK);
+            file.read(&input[0], input.size());
+            if (file.gcount() == 0) {
+                finished = true;
+                return;
+            }
+            inflater.next_in = (unsigned char*)&input[0];
+            inflater.avail_in = file.gcount();
+        }
+        inflater.next_out = output;
+        inflater.avail_out = sizeof(output);
+        int result = inflate(&inflater, Z_NO_FLUSH);
+        size_t have = sizeof(output) - inflater.avail_out;
+        size_t dropped = std::min<long long>(skip, have);
+        skip -= dropped;
+        pending.append((char*)output + dropped, have - dropped);
+        if (result == Z_STREAM_END) {
+            // .gz - несколько gzip-членов подряд (заголовок и тело);
+            // при распаковке с точки сброса после тела идёт только хвост gzip
+            if (gzip_header && inflateReset(&inflater) == Z_OK) {
+                return;
+            }
+            finished = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            finished = true;
+        }
+    }
+
+    // расшифровывает участок .bin от текущего кадра до следующего
+    void fill_binary() {
+        if (bin_frame < 0) {
+            finished = true;
+            return;
+        }
+        long long start = index.is_loaded()? index.at(bin_frame).bin_offset : 0;
+        long long end = -1;
+        int next = bin_frame + 1;
+        while (index.is_loaded() && next < index.size() && index.at(next).bin_offset < 0) {
+            next++;
+        }
+        if (index.is_loaded() && next < index.size()) {
+            end = index.at(next).bin_offset;
+        }
+        bin_frame = index.is_loaded() && next < index.size()? next : -1;
+
+        file.clear();
+        file.seekg(0, std::ios::end);
+        if (end < 0) {
+            end = file.tellg();
+        }
+        std::string data(end - start, '\0');
+        file.seekg(start);
+        file.read(&data[0], data.size());
+        data.resize(file.gcount());
+
+        bool ok;
+        if (start == 0) {
+            BinaryLogReader reader(data.data(), data.size());
+            float32 = reader.is_float32();
+            ok = reader.is_valid() && binary_events_to_text(reader, pending);
+        } else {
+            BinaryLogReader reader(data.data(), data.size(), float32);
+            ok = binary_events_to_text(reader, pending);
+        }
+        if (! ok) {
+            std::fprintf(stderr, "broken binary log at %lld\n", start);
+            finished = true;
+        }
+    }
+
+public:
+    explicit ReplayCursor(const std::string &log_path) :
+        source(SOURCE_TEXT),
+        file(log_path, std::ios::in | std::ios::binary),
+        frame(0),
+        pending_pos(0),
+        finished(false),
+        inflating(false),
+        gzip_header(false),
+        skip(0),
+        float32(false),
+        bin_frame(0)
+    {
+        if (ends_with(log_path, ".gz")) {
+            source = SOURCE_GZIP;
+        } else if (ends_with(log_path, ".bin")) {
+            source = SOURCE_BINARY;
+            char header[REPLAY_HEADER_SIZE];
+            if (file.read(header, sizeof(header))) {
+                float32 = (header[5] & REPLAY_FLOAT32) != 0;
+            }
+        }
+        index.load(replay_index_path(log_path));
+        seek(0);
+    }
+
+    ~ReplayCursor() {
+        stop_inflating();
+    }
+
+    bool is_open() const {
+        return file.is_open();
+    }
+
+    bool has_index() const {
+        return index.is_loaded();
+    }
+
+    // тик ключевого кадра, на котором встал последний seek
+    int keyframe_tick() const {
+        return index.is_loaded()? index.at(frame).tick : 0;
+    }
+
+    // встаёт на ключевой кадр не позже tick; false - файл не открыт
+    bool seek(int tick) {
+        pending.clear();
+        pending_pos = 0;
+        finished = false;
+        frame = index.is_loaded()? index.find(tick) : 0;
+        ReplayKeyframe start = index.is_loaded()? index.at(frame) : ReplayKeyframe();
+        if (! file.is_open()) {
+            finished = true;
+            return false;
+        }
+        if (source == SOURCE_TEXT) {
+            file.clear();
+            file.seekg(start.log_offset);
+        } else if (source == SOURCE_GZIP) {
+            bool from_start = start.gz_offset == 0;
+            skip = start.log_offset - (from_start? 0 : start.gz_log_offset);
+            if (! start_inflating(start.gz_offset, from_start)) {
+                finished = true;
+                return false;
+            }
+        } else {
+            // если двоичный лог начат позже этого кадра - читаем с начала
+            frame = start.bin_offset < 0? 0 : frame;
+            bin_frame = frame;
+        }
+        // смещение кадра указывает на пустую строку перед "T{tick}" (см.
+        // append_tick_line): пропускаем её, чтобы next_line начал с метки тика
+        if (frame > 0) {
+            while (pending.empty() && fill()) {}
+            if (! pending.empty() && pending[0] == '\n') {
+                pending_pos = 1;
+            }
+        }
+        return true;
+    }
+
+    // весь оставшийся текст лога (из .gz - распакованный)
+    void read_rest(std::string &text) {
+        while (fill()) {}
+        text.assign(pending, pending_pos, std::string::npos);
+        pending.clear();
+        pending_pos = 0;
+    }
+
+    // следующая строка текста лога без '\n'; false - лог кончился
+    bool next_line(std::string &line) {
+        size_t end;
+        while ((end = pending.find('\n', pending_pos)) == std::string::npos) {
+            if (pending_pos > 0) {
+                pending.erase(0, pending_pos);
+                pending_pos = 0;
+            }
+            if (! fill()) {
+                if (pending_pos == pending.size()) {
+                    return false;
+                }
+                line.assign(pending, pending_pos, std::string::npos);
+                pending_pos = pending.size();
+                return true;
+            }
+        }
+        line.assign(pending, pending_pos, end - pending_pos);
+        pending_pos = end + 1;
+        return true;
+    }
+};
+
+#endif // REPLAY_INDEX_H
@@ -0,0 +1,676 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include "entities/circle.h"
+#include "mapped_file.h"
+#include "replay_format.h"
+#include "replay_index.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// номера игроков в командах: 0..REPLAY_PLAYER_IDS-1
+#define REPLAY_PLAYER_IDS 10
+// лог короче этого на куски для потоков не делится
+#define REPLAY_MIN_CHUNK (1 << 20)
+// кусков на поток: пул раздаёт их по мере освобождения потоков
+#define REPLAY_CHUNKS_PER_THREAD 4
+
+
+// Записи, сгруппированные по тикам: все записи лежат в одном векторе подряд,
+// а для каждого тика, начиная с первого записанного, хранится начало его
+// отрезка. Тики добавляются только по возрастанию, как идут в логе.
+template <typename T>
+class ReplayTickTable
+{
+public:
+    ReplayTickTable():
+        first_tick_(0)
+    {}
+
+    void add(int tick, const T &item) {
+        if (starts_.empty()) {
+            first_tick_ = tick;
+        }
+        while (first_tick_ + (int)starts_.size() <= tick) {
+            starts_.push_back(items_.size());
+        }
+        items_.push_back(item);
+    }
+
+    // дописывает таблицу следующего куска лога (её тики - позже наших)
+    void append(const ReplayTickTable &next) {
+        if (next.starts_.empty()) {
+            return;
+        }
+        if (starts_.empty()) {
+            *this = next;
+            return;
+        }
+        while (first_tick_ + (int)starts_.size() < next.first_tick_) {
+            starts_.push_back(items_.size());
+        }
+        size_t shift = items_.size();
+        for (size_t start : next.starts_) {
+            starts_.push_back(start + shift);
+        }
+        items_.insert(items_.end(), next.items_.begin(), next.items_.end());
+    }
+
+    // отрезок [first, last) записей тика
+    void range(int tick, size_t &first, size_t &last) const {
+        int index = tick - first_tick_;
+        if (index < 0 || index >= (int)starts_.size()) {
+            first = last = 0;
+            return;
+        }
+        first = starts_[index];
+        last = index + 1 < (int)starts_.size()? starts_[index + 1] : items_.size();
+    }
+
+    const T &operator[](size_t index) const {
+        return items_[index];
+    }
+
+private:
+    int first_tick_;
+    std::vector<T> items_;
+    std::vector<size_t> starts_;
+};
+
+
+// Лог игры для повтора: команды игроков, их положения и начальные точки еды,
+// вирусов и игроков по тикам. Файл отображается в память и разбирается на
+// месте, без построчного копирования; двоичный лог (replay_format.h) читается
+// прямо из записей. Архив .gz распаковывается в память целиком.
+//
+// Большой лог делится на куски по базовым тикам (метки T{tick} с tick кратным
+// BASE_TICK, в двоичном логе - ключевые кадры из индекса .idx), куски
+// разбираются параллельно на threads_cnt потоках (0 - по числу ядер) и
+// склеиваются: тики кусков идут подряд и не пересекаются.
+//
+// Числа двоичного лога точные, а текстового - %.16g, который double не
+// восстанавливает. Обычно из двоичного лога числа берутся в том же виде, что и
+// из текста, чтобы повтор по .log и по .bin шёл одинаково; с exact - как есть
+// (проверка детерминизма, replay_verify).
+class ReplayLog {
+public:
+    explicit ReplayLog(const std::string &log_txt, int threads_cnt=0, bool exact=false):
+        params_(),
+        exact_(exact),
+        tick_(0),
+        commands_tick_(0)
+    {
+        MappedFile file;
+        std::string unpacked;       // текст из .gz
+        const char *data;
+        size_t size;
+        if (log_txt.size() > 3 && log_txt.compare(log_txt.size() - 3, 3, ".gz") == 0) {
+            ReplayCursor cursor(log_txt);
+            if (!cursor.is_open()) {
+                std::fprintf(stderr, "cannot read %s\n", log_txt.c_str());
+                return;
+            }
+            cursor.read_rest(unpacked);
+            data = unpacked.data();
+            size = unpacked.size();
+        } else if (file.open(log_txt)) {
+            data = file.data();
+            size = file.size();
+        } else {
+            std::fprintf(stderr, "cannot read %s\n", log_txt.c_str());
+            return;
+        }
+        if (threads_cnt <= 0) {
+            threads_cnt = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        int chunks_cnt = threads_cnt == 1? 1 :
+                std::min<size_t>(threads_cnt * REPLAY_CHUNKS_PER_THREAD, size / REPLAY_MIN_CHUNK);
+        bool binary = BinaryLogReader::is_binary(data, size);
+        bool float32 = binary && BinaryLogReader(data, size).is_float32();
+        std::vector<size_t> bounds = binary?
+                    binary_bounds(log_txt, data, size, chunks_cnt) :
+                    text_bounds(data, size, chunks_cnt);
+
+        std::vector<std::unique_ptr<ReplayLog>> parts;
+        for (size_t I = 0; I + 1 < bounds.size(); I++) {
+            parts.emplace_back(new ReplayLog());
+            parts.back()->exact_ = exact;
+        }
+        std::vector<char> failed(parts.size(), 0);
+        auto parse_part = [&] (size_t I) {
+            const char *begin = data + bounds[I];
+            size_t part_size = bounds[I + 1] - bounds[I];
+            if (! binary) {
+                parts[I]->parse_text(begin, begin + part_size);
+            } else if (I == 0) {
+                BinaryLogReader reader(begin, part_size);
+                failed[I] = ! parts[I]->parse_binary(reader);
+            } else {
+                BinaryLogReader reader(begin, part_size, float32);
+                failed[I] = ! parts[I]->parse_binary(reader);
+            }
+        };
+        if (parts.size() == 1) {
+            parse_part(0);
+        } else {
+            WorkStealingPool pool(std::min<int>(threads_cnt, parts.size()));
+            for (size_t I = 0; I < parts.size(); I++) {
+                pool.submit([&parse_part, I] { parse_part(I); });
+            }
+            pool.wait();
+        }
+        for (size_t I = 0; I < parts.size(); I++) {
+            if (failed[I]) {
+                std::fprintf(stderr, "broken binary log %s\n", log_txt.c_str());
+            }
+            append(*parts[I]);
+        }
+    }
+
+    Direct get_command(int tick, int player_id) const {
+        Direct direct(0, 0);
+        if (!find_command(tick, player_id, direct)) {
+            std::fprintf(stderr, "no key %d %d\n", tick, player_id);
+            std::abort();
+        }
+        return direct;
+    }
+
+    // команда игрока на тике; false - в логе её нет
+    bool find_command(int tick, int player_id, Direct &direct) const {
+        size_t index = size_t(tick - commands_tick_) * REPLAY_PLAYER_IDS + player_id;
+        if (tick < commands_tick_ || player_id < 0 || player_id >= REPLAY_PLAYER_IDS ||
+                index >= commands_.size() || !commands_[index].is_set) {
+            return false;
+        }
+        const Command &command = commands_[index];
+        direct = Direct(command.x, command.y);
+        direct.split = command.flag == 'S';
+        direct.eject = command.flag == 'E';
+        return true;
+    }
+
+    // положение фрагмента на тике, если оно есть в логе (последнее из записанных)
+    bool get_player_pos(int tick, int id, int fragment_id, double &x, double &y) const {
+        size_t first, last;
+        positions_.range(tick, first, last);
+        while (last > first) {
+            const Position &position = positions_[--last];
+            if (position.id == id && position.fragment_id == fragment_id) {
+                x = position.x;
+                y = position.y;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // очередная точка вида type ("AF", "AV", "AP") на тике
+    std::pair<double, double> get_point(int tick, const std::string& type) {
+        int kind = point_kind(type.size() == 2 && type[0] == 'A'? type[1] : '\0');
+        size_t first = 0, last = 0;
+        size_t taken_index = size_t(tick) * POINT_KINDS + kind;
+        if (kind >= 0 && tick >= 0) {
+            points_[kind].range(tick, first, last);
+            if (taken_index >= points_taken_.size()) {
+                points_taken_.resize(taken_index + 1, 0);
+            }
+            first += points_taken_[taken_index];
+        }
+        if (first >= last) {
+            std::fprintf(stderr, "no points %d %s\n", tick, type.c_str());
+            std::abort();
+        }
+        points_taken_[taken_index]++;
+        const Point &point = points_[kind][first];
+        return std::make_pair(point.x, point.y);
+    }
+
+    // Очередная точка вида type на тике у объекта с номером не меньше first_id;
+    // false - точки кончились. На базовом тике в логе лежат все объекты, а не
+    // только новые, а отвергнутые механикой точки (место занято) не пишутся
+    // вовсе - новые объекты отличаются по номеру.
+    bool find_new_point(int tick, const std::string& type, int first_id, std::pair<double, double> &result) {
+        int kind = point_kind(type.size() == 2 && type[0] == 'A'? type[1] : '\0');
+        if (kind < 0 || tick < 0) {
+            return false;
+        }
+        size_t first, last;
+        points_[kind].range(tick, first, last);
+        size_t taken_index = size_t(tick) * POINT_KINDS + kind;
+        if (taken_index >= points_taken_.size()) {
+            points_taken_.resize(taken_index + 1, 0);
+        }
+        size_t skip = points_taken_[taken_index];
+        for (size_t I = first; I < last; I++) {
+            const Point &point = points_[kind][I];
+            if (point.id < first_id) {
+                continue;
+            }
+            if (skip == 0) {
+                points_taken_[taken_index]++;
+                result = std::make_pair(point.x, point.y);
+                return true;
+            }
+            skip--;
+        }
+        return false;
+    }
+
+    // динамические параметры игры из заголовка лога
+    const std::map<std::string, std::string> &params() const {
+        return params_;
+    }
+
+    // прочие параметры из заголовка (строки OD и OW): TICK_MS, GAME_TICKS,
+    // BASE_TICK, GAME_WIDTH, GAME_HEIGHT
+    const std::map<std::string, std::string> &header() const {
+        return header_;
+    }
+
+private:
+    enum {POINT_FOOD, POINT_VIRUS, POINT_PLAYER, POINT_KINDS};
+
+    struct Command {
+        double x, y;
+        char flag;          // 'S', 'E' или 0
+        bool is_set;
+    };
+
+    struct Position {
+        int id, fragment_id;
+        double x, y;
+    };
+
+    struct Point {
+        int id;
+        double x, y;
+    };
+
+    // слово строки: [begin, end)
+    struct Token {
+        const char *begin, *end;
+    };
+
+    enum {MAX_TOKENS = 8};
+
+    // кусок лога до склейки
+    ReplayLog():
+        exact_(false),
+        tick_(0),
+        commands_tick_(0)
+    {}
+
+    // дописывает разобранный следующий кусок лога
+    void append(ReplayLog &next) {
+        params_.insert(next.params_.begin(), next.params_.end());
+        header_.insert(next.header_.begin(), next.header_.end());
+        if (commands_.empty()) {
+            commands_tick_ = next.commands_tick_;
+            commands_.swap(next.commands_);
+        } else if (! next.commands_.empty()) {
+            Command empty = {0, 0, 0, false};
+            commands_.resize(size_t(next.commands_tick_ - commands_tick_) * REPLAY_PLAYER_IDS, empty);
+            commands_.insert(commands_.end(), next.commands_.begin(), next.commands_.end());
+        }
+        positions_.append(next.positions_);
+        for (int I = 0; I < POINT_KINDS; I++) {
+            points_[I].append(next.points_[I]);
+        }
+        tick_ = std::max(tick_, next.tick_);
+    }
+
+    // Границы кусков текстового лога: начало файла, начала строк T{tick} с
+    // tick кратным BASE_TICK возле равных долей файла, конец файла.
+    static std::vector<size_t> text_bounds(const char *data, size_t size, int chunks_cnt) {
+        std::vector<size_t> bounds(1, 0);
+        int base_tick = chunks_cnt > 1? header_base_tick(data, data + size) : 0;
+        for (int I = 1; I < chunks_cnt && base_tick > 0; I++) {
+            size_t bound = next_base_tick(data, size, std::max(bounds.back(), size / chunks_cnt * I), base_tick);
+            if (bound >= size) {
+                break;
+            }
+            if (bound > bounds.back()) {
+                bounds.push_back(bound);
+            }
+        }
+        bounds.push_back(size);
+        return bounds;
+    }
+
+    // BASE_TICK из строки "OD T{} G{} B{}" заголовка; 0 - не нашлась
+    static int header_base_tick(const char *p, const char *end) {
+        while (p < end && *p != 'T') {
+            const char *line_end = (const char*)std::memchr(p, '\n', end - p);
+            if (line_end == NULL) {
+                line_end = end;
+            }
+            if (line_end - p > 3 && std::memcmp(p, "OD ", 3) == 0) {
+                Token parts[MAX_TOKENS];
+                int count = split(p, line_end, parts);
+                for (int I = 1; I < count; I++) {
+                    if (starts_with(parts[I], "B")) {
+                        return to_int(parts[I].begin + 1, parts[I].end);
+                    }
+                }
+            }
+            p = line_end + 1;
+        }
+        return 0;
+    }
+
+    // смещение первой после from строки T{tick} с tick кратным base_tick
+    static size_t next_base_tick(const char *data, size_t size, size_t from, int base_tick) {
+        const char *end = data + size;
+        const char *p = data + from;
+        while (p < end && (p = (const char*)std::memchr(p, '\n', end - p)) != NULL) {
+            p++;
+            if (p == end || *p != 'T') {
+                continue;
+            }
+            const char *digit = p + 1;
+            int tick = 0;
+            for (; digit < end && *digit >= '0' && *digit <= '9'; digit++) {
+                tick = tick * 10 + (*digit - '0');
+            }
+            if (digit > p + 1 && (digit == end || *digit == '\n') && tick % base_tick == 0) {
+                return p - data;
+            }
+        }
+        return size;
+    }
+
+    // Границы кусков двоичного лога: ключевые кадры из индекса. Без индекса
+    // (или если он не от этого файла) лог разбирается целиком.
+    static std::vector<size_t> binary_bounds(const std::string &log_path, const char *data, size_t size, int chunks_cnt) {
+        std::vector<size_t> bounds(1, 0);
+        ReplayIndex index;
+        if (chunks_cnt > 1 && index.load(replay_index_path(log_path))) {
+            int frame = 0;
+            for (int I = 1; I < chunks_cnt; I++) {
+                size_t target = size / chunks_cnt * I;
+                while (frame < index.size() && (index.at(frame).bin_offset < 0 || size_t(index.at(frame).bin_offset) < target)) {
+                    frame++;
+                }
+                if (frame == index.size()) {
+                    break;
+                }
+                size_t bound = index.at(frame).bin_offset;
+                if (bound >= size || (unsigned char)data[bound] != REPLAY_KEYFRAME) {
+                    bounds.resize(1);
+                    break;
+                }
+                if (bound > bounds.back()) {
+                    bounds.push_back(bound);
+                }
+            }
+        }
+        bounds.push_back(size);
+        return bounds;
+    }
+
+    static int point_kind(char type) {
+        switch (type) {
+        case 'F': return POINT_FOOD;
+        case 'V': return POINT_VIRUS;
+        case 'P': return POINT_PLAYER;
+        }
+        return -1;
+    }
+
+    void set_tick(int tick) {
+        // записи тиков хранятся по возрастанию; в логе тики и идут по возрастанию
+        if (tick < tick_) {
+            std::fprintf(stderr, "tick %d after %d ignored\n", tick, tick_);
+            return;
+        }
+        tick_ = tick;
+    }
+
+    void add_command(int player_id, double x, double y, char flag) {
+        if (player_id < 0 || player_id >= REPLAY_PLAYER_IDS) {
+            return;
+        }
+        if (commands_.empty()) {
+            commands_tick_ = tick_;
+        }
+        size_t index = size_t(tick_ - commands_tick_) * REPLAY_PLAYER_IDS + player_id;
+        if (index >= commands_.size()) {
+            Command empty = {0, 0, 0, false};
+            commands_.resize((size_t(tick_ - commands_tick_) + 1) * REPLAY_PLAYER_IDS, empty);
+        }
+        Command command = {x, y, flag, true};
+        commands_[index] = command;
+    }
+
+    void add_position(int id, int fragment_id, double x, double y) {
+        Position position = {id, fragment_id, x, y};
+        positions_.add(tick_, position);
+    }
+
+    void add_point(int kind, int id, double x, double y) {
+        Point point = {id, x, y};
+        points_[kind].add(tick_, point);
+    }
+
+    bool parse_binary(BinaryLogReader &reader) {
+        LogRecord record;
+        int tick;
+        while (true) {
+            switch (reader.next(record, tick)) {
+            case BinaryLogReader::EVENT_END:
+                return true;
+            case BinaryLogReader::EVENT_ERROR:
+                return false;
+            case BinaryLogReader::EVENT_TICK:
+                set_tick(tick);
+                break;
+            case BinaryLogReader::EVENT_TEXT:
+                parse_text(record.text.data(), record.text.data() + record.text.size());
+                break;
+            case BinaryLogReader::EVENT_RECORD:
+                add_record(record);
+                break;
+            }
+        }
+    }
+
+    // число двоичного лога в том виде, в каком оно было бы прочитано из текста
+    double as_text(double value) const {
+        if (exact_) {
+            return value;
+        }
+        char buffer[NUMBER_BUFFER_SIZE];
+        buffer[write_number(buffer, value)] = '\0';
+        return std::strtod(buffer, NULL);
+    }
+
+    void add_record(const LogRecord &record) {
+        double x = record.v[0], y = record.v[1];
+        switch (record.kind) {
+        case LOG_DIRECT:
+            add_command(record.id, as_text(x), as_text(y), 0);
+            break;
+        case LOG_DIRECT_FOR:
+            add_command(record.id, as_text(x), as_text(y), char(record.num));
+            break;
+        case LOG_POS_PLAYER:
+        case LOG_MASS:
+            add_position(record.id, record.fragment_id, as_text(x), as_text(y));
+            break;
+        case LOG_ADD_FOOD:
+            add_point(POINT_FOOD, record.id, as_text(x), as_text(y));
+            break;
+        case LOG_ADD_VIRUS:
+            add_point(POINT_VIRUS, record.id, as_text(x), as_text(y));
+            break;
+        case LOG_ADD_PLAYER:
+            add_point(POINT_PLAYER, record.id, as_text(x), as_text(y));
+            break;
+        }
+    }
+
+    void parse_text(const char *p, const char *end) {
+        while (p < end) {
+            const char *line_end = (const char*)std::memchr(p, '\n', end - p);
+            if (line_end == NULL) {
+                line_end = end;
+            }
+            parse_line(p, line_end);
+            p = line_end + 1;
+        }
+    }
+
+    void parse_line(const char *begin, const char *end) {
+        if (begin == end) {
+            return;
+        }
+        if (begin[0] == '#') {
+            parse_params(begin, end);
+            return;
+        }
+        Token parts[MAX_TOKENS];
+        int count = split(begin, end, parts);
+        switch (begin[0]) {
+        case 'T':
+            set_tick(to_int(begin + 1, end));
+            break;
+        case 'O':
+            if (count > 1 && begin + 1 < end && (begin[1] == 'D' || begin[1] == 'W') && parts[0].end == begin + 2) {
+                parse_header(begin[1], parts + 1, count - 1);
+            }
+            break;
+        case 'C':
+            if (count > 2) {
+                const Token &last = parts[count - 1];
+                char flag = last.end - last.begin == 1 && (last.begin[0] == 'S' || last.begin[0] == 'E')? last.begin[0] : 0;
+                add_command(to_int(begin + 1, parts[0].end),
+                            to_double(parts[1].begin + 1, parts[1].end),
+                            to_double(parts[2].begin + 1, parts[2].end), flag);
+            }
+            break;
+        case '+':
+            if (begin + 1 < end && begin[1] == 'P' && count > 2 && starts_with(parts[1], "X")) {
+                const char *dot = (const char*)std::memchr(begin + 2, '.', parts[0].end - begin - 2);
+                int id = to_int(begin + 2, dot != NULL? dot : parts[0].end);
+                int fragment_id = dot != NULL? to_int(dot + 1, parts[0].end) : 0;
+                add_position(id, fragment_id,
+                             to_double(parts[1].begin + 1, parts[1].end),
+                             to_double(parts[2].begin + 1, parts[2].end));
+            }
+            break;
+        case 'A':
+            if (begin + 1 < end && count > 2) {
+                int kind = point_kind(begin[1]);
+                if (kind >= 0) {
+                    const char *dot = (const char*)std::memchr(begin + 2, '.', parts[0].end - begin - 2);
+                    add_point(kind, to_int(begin + 2, dot != NULL? dot : parts[0].end),
+                              to_double(parts[1].begin + 1, parts[1].end),
+                              to_double(parts[2].begin + 1, parts[2].end));
+                }
+            }
+            break;
+        }
+    }
+
+    // "# Dynamic params KEY=value ..."
+    void parse_params(const char *begin, const char *end) {
+        static const char prefix[] = "# Dynamic params ";
+        size_t len = sizeof(prefix) - 1;
+        if (size_t(end - begin) < len || std::memcmp(begin, prefix, len) != 0) {
+            return;
+        }
+        const char *p = begin + len;
+        while (p <= end) {
+            const char *word_end = (const char*)std::memchr(p, ' ', end - p);
+            if (word_end == NULL) {
+                word_end = end;
+            }
+            const char *eq = (const char*)std::memchr(p, '=', word_end - p);
+            if (eq == NULL) {
+                params_[std::string(p, word_end)] = "";
+            } else {
+                params_[std::string(p, eq)] = std::string(eq + 1, word_end);
+            }
+            p = word_end + 1;
+        }
+    }
+
+    // "OD T{TICK_MS} G{GAME_TICKS} B{BASE_TICK}", "OW W{GAME_WIDTH} H{GAME_HEIGHT} S{сид}"
+    void parse_header(char type, const Token *parts, int count) {
+        static const char *names[2][3][2] = {
+            {{"T", "TICK_MS"}, {"G", "GAME_TICKS"}, {"B", "BASE_TICK"}},
+            {{"W", "GAME_WIDTH"}, {"H", "GAME_HEIGHT"}, {"", ""}}
+        };
+        for (int I = 0; I < count; I++) {
+            for (auto &name : names[type == 'D'? 0 : 1]) {
+                if (name[0][0] != '\0' && parts[I].begin < parts[I].end && parts[I].begin[0] == name[0][0]) {
+                    header_[name[1]] = std::string(parts[I].begin + 1, parts[I].end);
+                }
+            }
+        }
+    }
+
+    // делит строку по пробелам; слова сверх MAX_TOKENS - 1 сливаются в последнее
+    static int split(const char *begin, const char *end, Token *parts) {
+        int count = 0;
+        const char *start = begin;
+        for (const char *p = begin; p <= end; p++) {
+            if (p == end || (*p == ' ' && count < MAX_TOKENS - 1)) {
+                parts[count].begin = start;
+                parts[count].end = p;
+                count++;
+                start = p + 1;
+            }
+        }
+        return count;
+    }
+
+    static bool starts_with(const Token &token, const char *prefix) {
+        size_t len = std::strlen(prefix);
+        return size_t(token.end - token.begin) >= len && std::memcmp(token.begin, prefix, len) == 0;
+    }
+
+    static int to_int(const char *begin, const char *end) {
+        bool negative = begin < end && *begin == '-';
+        if (negative) {
+            begin++;
+        }
+        int value = 0;
+        for (; begin < end && *begin >= '0' && *begin <= '9'; begin++) {
+            value = value * 10 + (*begin - '0');
+        }
+        return negative? -value : value;
+    }
+
+    // strtod нужна строка с нулём в конце, а в отображённом файле его нет
+    static double to_double(const char *begin, const char *end) {
+        char buffer[64];
+        size_t len = std::min<size_t>(end - begin, sizeof(buffer) - 1);
+        std::memcpy(buffer, begin, len);
+        buffer[len] = '\0';
+        return std::strtod(buffer, NULL);
+    }
+
+    std::map<std::string, std::string> params_;
+    std::map<std::string, std::string> header_;
+    bool exact_;
+    int tick_;
+    int commands_tick_;                         // тик первой строки commands_
+    std::vector<Command> commands_;             // по тику и номеру игрока
+    ReplayTickTable<Position> positions_;
+    ReplayTickTable<Point> points_[POINT_KINDS];
+    std::vector<size_t> points_taken_;          // уже выданные точки по тику и виду
+};
+
+#endif // REPLAY_LOG_H
@@ -0,0 +1,38 @@
+#ifndef SHARED_BUFFER_H
+#define SHARED_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+
+// Готовое сообщение стратегии. После записи не меняется, и его держат сразу
+// очередь отправки в сокет и очередь дампа (Logger::write_raw): текст лежит
+// в памяти один раз, освобождает его тот, кто отпустит последним.
+typedef std::shared_ptr<const std::string> SharedBuffer;
+
+// Место для следующего сообщения. Если прежнее больше никто не держит, строка
+// переиспользуется вместе с ёмкостью, иначе заводится новая.
+class SharedBufferSlot
+{
+private:
+    std::shared_ptr<std::string> buffer;
+
+public:
+    std::string &acquire() {
+        if (! buffer || buffer.use_count() > 1) {
+            buffer = std::make_shared<std::string>();
+        } else {
+            // последнюю ссылку мог отпустить поток логгера: его чтение
+            // должно закончиться до нашей записи
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *buffer;
+    }
+
+    SharedBuffer get() const {
+        return buffer;
+    }
+};
+
+#endif // SHARED_BUFFER_H
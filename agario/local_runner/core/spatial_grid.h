@@ -0,0 +1,96 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+// Равномерная сетка над игровым полем. Объект регистрируется во всех ячейках,
+// которые накрывает квадрат (x ± radius, y ± radius); внутри ячейки объекты
+// лежат в порядке вставки, поэтому обход ячейки повторяет порядок исходного массива.
+template <typename T>
+class SpatialGrid
+{
+protected:
+    double cell_size;
+    int cols, rows;
+    std::vector<std::vector<T>> cells;
+
+public:
+    explicit SpatialGrid(double _cell_size) :
+        cell_size(_cell_size),
+        cols(0), rows(0)
+    {}
+
+    // очищает сетку, сохраняя выделенную под ячейки память
+    void reset(double width, double height) {
+        int new_cols = std::max(1, int(std::ceil(width / cell_size)));
+        int new_rows = std::max(1, int(std::ceil(height / cell_size)));
+        if (new_cols != cols || new_rows != rows) {
+            cols = new_cols;
+            rows = new_rows;
+            cells.assign(cols * rows, std::vector<T>());
+            return;
+        }
+        for (std::vector<T> &cell : cells) {
+            cell.clear();
+        }
+    }
+
+    void insert(T item, double x, double y, double radius=0) {
+        int x0 = col_of(x - radius), x1 = col_of(x + radius);
+        int y0 = row_of(y - radius), y1 = row_of(y + radius);
+        for (int row = y0; row <= y1; row++) {
+            for (int col = x0; col <= x1; col++) {
+                cells[row * cols + col].push_back(item);
+            }
+        }
+    }
+
+    // координаты и радиус должны совпадать с переданными в insert
+    void remove(T item, double x, double y, double radius=0) {
+        int x0 = col_of(x - radius), x1 = col_of(x + radius);
+        int y0 = row_of(y - radius), y1 = row_of(y + radius);
+        for (int row = y0; row <= y1; row++) {
+            for (int col = x0; col <= x1; col++) {
+                std::vector<T> &cell = cells[row * cols + col];
+                auto it = std::find(cell.begin(), cell.end(), item);
+                if (it != cell.end()) {
+                    cell.erase(it);
+                }
+            }
+        }
+    }
+
+    // все объекты, чей квадрат накрывает точку (x, y)
+    const std::vector<T> &at(double x, double y) const {
+        return cells[row_of(y) * cols + col_of(x)];
+    }
+
+    // обходит ячейки, пересекающие квадрат (x ± radius, y ± radius);
+    // объект, вставленный точкой, будет передан в visit ровно один раз
+    template <typename Visitor>
+    void query(double x, double y, double radius, Visitor visit) const {
+        int x0 = col_of(x - radius), x1 = col_of(x + radius);
+        int y0 = row_of(y - radius), y1 = row_of(y + radius);
+        for (int row = y0; row <= y1; row++) {
+            for (int col = x0; col <= x1; col++) {
+                for (T item : cells[row * cols + col]) {
+                    visit(item);
+                }
+            }
+        }
+    }
+
+private:
+    int col_of(double x) const {
+        return std::min(cols - 1, std::max(0, int(std::floor(x / cell_size))));
+    }
+
+    int row_of(double y) const {
+        return std::min(rows - 1, std::max(0, int(std::floor(y / cell_size))));
+    }
+};
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,66 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+// Кольцевая очередь без блокировок на одного писателя и одного читателя.
+// Элементы создаются один раз при создании очереди и переиспользуются: писатель
+// заполняет свободную ячейку на месте (acquire + push), читатель обрабатывает
+// её тоже на месте (front + pop). Так строки внутри записей сохраняют буферы и
+// после разогрева очередь ничего не выделяет.
+template <typename T>
+class SpscQueue
+{
+private:
+    std::vector<T> slots;
+    size_t mask;
+    // head двигает только читатель, tail - только писатель
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+public:
+    // capacity - степень двойки
+    explicit SpscQueue(size_t capacity) :
+        slots(capacity),
+        mask(capacity - 1),
+        head(0),
+        tail(0)
+    {}
+
+    // свободная ячейка для писателя или NULL, если очередь заполнена
+    T *acquire() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) {
+            return NULL;
+        }
+        return &slots[t & mask];
+    }
+
+    // публикует ячейку, полученную acquire()
+    void push() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // первая ячейка для читателя или NULL, если очередь пуста
+    T *front() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return NULL;
+        }
+        return &slots[h & mask];
+    }
+
+    // освобождает ячейку, полученную front()
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SPSC_QUEUE_H
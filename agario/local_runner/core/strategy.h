@@ -1,11 +1,10 @@
 #ifndef STARTEGY_H
 #define STARTEGY_H
 
-#include "../entities/player.h"
-#include "../replay_log.h"
+#include "entities/player.h"
 
 
-class Strategy : public QObject
+class Strategy
 {
 protected:
     int id;
@@ -58,6 +57,6 @@ public:
     }
 };
 
-typedef QVector<Strategy*> StrategyArray;
+typedef std::vector<Strategy*> StrategyArray;
 
 #endif // STARTEGY_H
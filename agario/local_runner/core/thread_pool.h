@@ -0,0 +1,135 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Пул с переманиванием задач: у каждого потока своя очередь, свои задачи он
+// берёт с конца, а когда они кончаются - забирает чужие с начала. Длина игр
+// сильно разная, поэтому статическая раздача сидов по потокам не годится.
+// Им же ReplayLog разбирает куски большого лога.
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<int> queued;   // лежат в очередях
+    std::atomic<int> pending;  // ещё не выполнены
+    std::atomic<unsigned> next_worker;
+
+    std::mutex state_lock;
+    std::condition_variable has_work;
+    std::condition_variable all_done;
+    bool stopping;
+
+public:
+    explicit WorkStealingPool(int threads_cnt) :
+        queued(0),
+        pending(0),
+        next_worker(0),
+        stopping(false)
+    {
+        threads_cnt = std::max(1, threads_cnt);
+        for (int I = 0; I < threads_cnt; I++) {
+            workers.emplace_back(new Worker);
+        }
+        for (int I = 0; I < threads_cnt; I++) {
+            threads.emplace_back(&WorkStealingPool::run, this, I);
+        }
+    }
+
+    virtual ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            stopping = true;
+        }
+        has_work.notify_all();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    int size() const {
+        return int(workers.size());
+    }
+
+    void submit(Task task) {
+        Worker &worker = *workers[next_worker++ % workers.size()];
+        {
+            std::lock_guard<std::mutex> guard(worker.lock);
+            worker.tasks.push_back(std::move(task));
+        }
+        pending++;
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            queued++;
+        }
+        has_work.notify_one();
+    }
+
+    // ждёт выполнения всех отправленных задач
+    void wait() {
+        std::unique_lock<std::mutex> guard(state_lock);
+        all_done.wait(guard, [this] { return pending == 0; });
+    }
+
+private:
+    bool pop(int self, Task &task) {
+        int count = int(workers.size());
+        for (int shift = 0; shift < count; shift++) {
+            Worker &worker = *workers[(self + shift) % count];
+            std::lock_guard<std::mutex> guard(worker.lock);
+            if (worker.tasks.empty()) {
+                continue;
+            }
+            if (shift == 0) {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            } else {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            }
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void run(int self) {
+        Task task;
+        while (true) {
+            if (pop(self, task)) {
+                task();
+                task = nullptr;
+                if (--pending == 0) {
+                    std::lock_guard<std::mutex> guard(state_lock);
+                    all_done.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(state_lock);
+            has_work.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return;
+            }
+        }
+    }
+};
+
+#endif // THREAD_POOL_H
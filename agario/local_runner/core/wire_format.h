@@ -0,0 +1,343 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include "constants.h"
+#include "json_writer.h"
+#include "entities/food.h"
+#include "entities/virus.h"
+#include "entities/player.h"
+#include "entities/ejection.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+// Двоичный протокол стратегий (клиент просит его в первом сообщении:
+// "protocol": "binary"). После JSON-строки подключения обе стороны шлют
+// кадры: u32 длина (без самого поля длины), u8 вид кадра, данные. Все числа
+// little-endian, int - 4 байта, double - 8 байт IEEE 754. Клиентская сторона -
+// dockers/cpp17/wire.
+//
+// WIRE_CONFIG (сервер): int GAME_WIDTH, GAME_HEIGHT, GAME_TICKS, MAX_FRAGS_CNT,
+//   TICKS_TIL_FUSION; double FOOD_MASS, VIRUS_RADIUS, VIRUS_SPLIT_MASS,
+//   VISCOSITY, INERTION_FACTOR, SPEED_FACTOR.
+// WIRE_STATE (сервер): int tick, u16 число своих фрагментов, u16 число
+//   видимых объектов, затем записи фрагментов по WIRE_FRAGMENT_SIZE байт:
+//     int id, fragment_id; double x, y, r, m, sx, sy; int ttf, 0
+//   и записи объектов по WIRE_OBJECT_SIZE байт:
+//     u8 тип ('F', 'E', 'V', 'P'), 3 нулевых байта; int id, extra, 0;
+//     double x, y, m, r
+//   extra - номер фрагмента у игрока и номер игрока у выброса. Поля, которых
+//   у объекта нет в JSON (масса еды, радиус вируса и т.п.), - нули.
+// WIRE_COMMAND (клиент): double x, y; u8 флаги (1 - Split, 2 - Eject);
+//   строки Debug, Sprite.Id, Sprite.S - u16 длина и байты UTF-8.
+// WIRE_ERROR (клиент): строка ошибки, как у WIRE_COMMAND.
+
+// формат состояний, который клиент выбрал при подключении ("protocol")
+enum StateProtocol {
+    PROTOCOL_JSON, PROTOCOL_DELTA, PROTOCOL_BINARY
+};
+
+enum WireFrameKind {
+    WIRE_CONFIG = 1, WIRE_STATE = 2, WIRE_COMMAND = 3, WIRE_ERROR = 4
+};
+
+#define WIRE_LENGTH_SIZE 4
+#define WIRE_FRAGMENT_SIZE 64
+#define WIRE_OBJECT_SIZE 48
+
+#define WIRE_SPLIT 1
+#define WIRE_EJECT 2
+
+
+class WireWriter
+{
+private:
+    static void put_u8(std::string &out, unsigned value) {
+        out += char(value & 0xFF);
+    }
+
+    static void put_u16(std::string &out, unsigned value) {
+        out += char(value & 0xFF);
+        out += char((value >> 8) & 0xFF);
+    }
+
+    static void put_int(std::string &out, int value) {
+        uint32_t bits = uint32_t(value);
+        for (int I = 0; I < 4; I++) {
+            out += char((bits >> (8 * I)) & 0xFF);
+        }
+    }
+
+    static void put_double(std::string &out, double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int I = 0; I < 8; I++) {
+            out += char((bits >> (8 * I)) & 0xFF);
+        }
+    }
+
+    // начало кадра: длина дописывается в end_frame
+    static size_t begin_frame(std::string &out, WireFrameKind kind) {
+        size_t start = out.size();
+        put_int(out, 0);
+        put_u8(out, kind);
+        return start;
+    }
+
+    static void end_frame(std::string &out, size_t start) {
+        uint32_t size = uint32_t(out.size() - start - WIRE_LENGTH_SIZE);
+        for (int I = 0; I < 4; I++) {
+            out[start + I] = char((size >> (8 * I)) & 0xFF);
+        }
+    }
+
+    static void put_fragment(std::string &out, const Player *player) {
+        put_int(out, player->getId());
+        put_int(out, player->get_fId());
+        put_double(out, player->getX());
+        put_double(out, player->getY());
+        put_double(out, player->getR());
+        put_double(out, player->getM());
+        put_double(out, player->get_speed() * std::cos(player->getA()));
+        put_double(out, player->get_speed() * std::sin(player->getA()));
+        put_int(out, player->fuse_timer > 0? player->fuse_timer : 0);
+        put_int(out, 0);
+    }
+
+    static void put_object(std::string &out, char type, int id, int extra, double x, double y, double m, double r) {
+        put_u8(out, type);
+        put_u8(out, 0); put_u8(out, 0); put_u8(out, 0);
+        put_int(out, id);
+        put_int(out, extra);
+        put_int(out, 0);
+        put_double(out, x);
+        put_double(out, y);
+        put_double(out, m);
+        put_double(out, r);
+    }
+
+    static void put_object(std::string &out, const Circle *circle) {
+        if (circle->is_player()) {
+            const Player *player = static_cast<const Player*>(circle);
+            put_object(out, 'P', player->getId(), player->get_fId(), player->getX(), player->getY(), player->getM(), player->getR());
+        } else if (circle->is_virus()) {
+            put_object(out, 'V', circle->getId(), 0, circle->getX(), circle->getY(), circle->getM(), 0);
+        } else if (circle->is_ejection()) {
+            const Ejection *eject = static_cast<const Ejection*>(circle);
+            put_object(out, 'E', eject->getId(), eject->get_player(), eject->getX(), eject->getY(), 0, 0);
+        } else {
+            put_object(out, 'F', circle->getId(), 0, circle->getX(), circle->getY(), 0, 0);
+        }
+    }
+
+public:
+    static void write_config(std::string &out, const GameConfig &config) {
+        out.clear();
+        size_t start = begin_frame(out, WIRE_CONFIG);
+        put_int(out, config.GAME_WIDTH);
+        put_int(out, config.GAME_HEIGHT);
+        put_int(out, config.GAME_TICKS);
+        put_int(out, config.MAX_FRAGS_CNT);
+        put_int(out, config.TICKS_TIL_FUSION);
+        put_double(out, config.FOOD_MASS);
+        put_double(out, config.VIRUS_RADIUS);
+        put_double(out, config.VIRUS_SPLIT_MASS);
+        put_double(out, config.VISCOSITY);
+        put_double(out, config.INERTION_FACTOR);
+        put_double(out, config.SPEED_FACTOR);
+        end_frame(out, start);
+    }
+
+    static void write_state(std::string &out, int tick, const PlayerArray &fragments, const CircleArray &visibles) {
+        out.clear();
+        out.reserve(16 + fragments.size() * WIRE_FRAGMENT_SIZE + visibles.size() * WIRE_OBJECT_SIZE);
+        size_t start = begin_frame(out, WIRE_STATE);
+        put_int(out, tick);
+        put_u16(out, fragments.size());
+        put_u16(out, visibles.size());
+        for (const Player *player : fragments) {
+            put_fragment(out, player);
+        }
+        for (const Circle *circle : visibles) {
+            put_object(out, circle);
+        }
+        end_frame(out, start);
+    }
+};
+
+
+// Команда стратегии из кадра WIRE_COMMAND или WIRE_ERROR
+struct WireCommand
+{
+    int kind;
+    double x, y;
+    int flags;
+    std::string debug, sprite_id, sprite;
+
+    // ответ для дампа - в том же виде, что и JSON-ответы
+    std::string to_json() const {
+        std::string out = "{";
+        if (kind == WIRE_ERROR) {
+            JsonWriter::append_key(out, "error", true); JsonWriter::append_string(out, debug);
+            return out + "}\n";
+        }
+        bool first = true;
+        if (! debug.empty()) {
+            JsonWriter::append_key(out, "Debug", first); JsonWriter::append_string(out, debug);
+            first = false;
+        }
+        if (flags & WIRE_EJECT) {
+            JsonWriter::append_key(out, "Eject", first); out += "true";
+            first = false;
+        }
+        if (! sprite_id.empty() || ! sprite.empty()) {
+            JsonWriter::append_key(out, "Sprite", first);
+            out += '{';
+            JsonWriter::append_key(out, "Id", true); JsonWriter::append_string(out, sprite_id);
+            JsonWriter::append_key(out, "S"); JsonWriter::append_string(out, sprite);
+            out += '}';
+            first = false;
+        }
+        if (flags & WIRE_SPLIT) {
+            JsonWriter::append_key(out, "Split", first); out += "true";
+            first = false;
+        }
+        JsonWriter::append_key(out, "X", first); JsonWriter::append_number(out, x);
+        JsonWriter::append_key(out, "Y"); JsonWriter::append_number(out, y);
+        return out + "}\n";
+    }
+};
+
+class WireReader
+{
+private:
+    const unsigned char *p, *end;
+
+    bool get_u16(unsigned &value) {
+        if (end - p < 2) {
+            return false;
+        }
+        value = p[0] | unsigned(p[1]) << 8;
+        p += 2;
+        return true;
+    }
+
+    bool get_int(int &value) {
+        if (end - p < 4) {
+            return false;
+        }
+        value = int32_t(p[0] | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24);
+        p += 4;
+        return true;
+    }
+
+    bool get_double(double &value) {
+        if (end - p < 8) {
+            return false;
+        }
+        uint64_t bits = 0;
+        for (int I = 0; I < 8; I++) {
+            bits |= uint64_t(p[I]) << (8 * I);
+        }
+        std::memcpy(&value, &bits, sizeof(value));
+        p += 8;
+        return true;
+    }
+
+    bool get_string(std::string &value) {
+        unsigned size;
+        if (! get_u16(size) || unsigned(end - p) < size) {
+            return false;
+        }
+        value.assign((const char*)p, size);
+        p += size;
+        return true;
+    }
+
+public:
+    // длина кадра в начале data; false - длины ещё нет целиком
+    static bool frame_size(const char *data, size_t size, uint32_t &frame) {
+        if (size < WIRE_LENGTH_SIZE) {
+            return false;
+        }
+        const unsigned char *bytes = (const unsigned char*)data;
+        frame = bytes[0] | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+        return true;
+    }
+
+    // data - кадр без поля длины
+    WireReader(const char *data, size_t size) :
+        p((const unsigned char*)data),
+        end((const unsigned char*)data + size)
+    {}
+
+    bool read_command(WireCommand &command) {
+        if (p >= end) {
+            return false;
+        }
+        command.kind = *p++;
+        command.x = command.y = 0;
+        command.flags = 0;
+        command.debug.clear();
+        command.sprite_id.clear();
+        command.sprite.clear();
+        if (command.kind == WIRE_ERROR) {
+            return get_string(command.debug);
+        }
+        if (command.kind != WIRE_COMMAND || ! get_double(command.x) || ! get_double(command.y) || p >= end) {
+            return false;
+        }
+        command.flags = *p++;
+        return get_string(command.debug) && get_string(command.sprite_id) && get_string(command.sprite);
+    }
+
+    static std::string id_to_str(int id, int fragment_id) {
+        if (fragment_id > 0) {
+            return std::to_string(id) + "." + std::to_string(fragment_id);
+        }
+        return std::to_string(id);
+    }
+
+    // Кадр WIRE_STATE в JSON полного состояния, побайтно как у
+    // JsonWriter::write_state: дамп двоичного клиента собирается из кадра
+    // потоком логгера, а поток игры сериализует состояние один раз.
+    bool read_state_json(std::string &out) {
+        int tick = 0, id = 0, fragment_id = 0, extra = 0, ttf = 0, zero = 0;
+        unsigned fragments_cnt = 0, objects_cnt = 0;
+        if (p >= end || *p++ != WIRE_STATE || ! get_int(tick) ||
+                ! get_u16(fragments_cnt) || ! get_u16(objects_cnt) ||
+                size_t(end - p) != fragments_cnt * WIRE_FRAGMENT_SIZE + objects_cnt * WIRE_OBJECT_SIZE) {
+            return false;
+        }
+        double x = 0, y = 0, r = 0, m = 0, sx = 0, sy = 0;
+        out += "{\"Mine\":[";
+        for (unsigned I = 0; I < fragments_cnt; I++) {
+            get_int(id); get_int(fragment_id);
+            get_double(x); get_double(y); get_double(r); get_double(m); get_double(sx); get_double(sy);
+            get_int(ttf); get_int(zero);
+            if (I > 0) out += ',';
+            JsonWriter::append_fragment(out, id_to_str(id, fragment_id), m, r, sx, sy, ttf, x, y);
+        }
+        out += "],\"Objects\":[";
+        for (unsigned I = 0; I < objects_cnt; I++) {
+            char type = char(*p);
+            p += 4;
+            get_int(id); get_int(extra); get_int(zero);
+            get_double(x); get_double(y); get_double(m); get_double(r);
+            if (I > 0) out += ',';
+            switch (type) {
+            case 'P': JsonWriter::append_player(out, id_to_str(id, extra), m, r, x, y); break;
+            case 'V': JsonWriter::append_virus(out, id, m, x, y); break;
+            case 'E': JsonWriter::append_eject(out, id, x, y, extra); break;
+            default:  JsonWriter::append_food(out, id, x, y); break;
+            }
+        }
+        out += "]}\n";
+        return true;
+    }
+};
+
+#endif // WIRE_FORMAT_H
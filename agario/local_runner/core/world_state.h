@@ -0,0 +1,44 @@
+#ifndef WORLD_STATE_H
+#define WORLD_STATE_H
+
+#include "entities/food.h"
+#include "entities/virus.h"
+#include "entities/player.h"
+#include "entities/ejection.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+
+// Плоская копия состояния Mechanic для перебора вперёд (см. Mechanic::snapshot).
+// Объекты хранятся по значению в порядке массивов механики; повторный snapshot
+// в тот же WorldState переиспользует выделенную память.
+struct WorldState
+{
+    int tick;
+    int id_counter;
+
+    std::vector<Food> foods;
+    std::vector<Ejection> ejections;
+    std::vector<Virus> viruses;
+    std::vector<Player> players;
+
+    std::vector<std::pair<int, int>> scores;
+    std::vector<std::pair<int, Direct>> directs;
+
+    std::mt19937_64 rand;
+
+    // отвязка форка от лога и от проигрываемого реплея
+    bool log_detached;
+    bool replay_detached;
+
+    explicit WorldState() :
+        tick(0),
+        id_counter(1),
+        log_detached(true),
+        replay_detached(true)
+    {}
+};
+
+#endif // WORLD_STATE_H
@@ -0,0 +1,893 @@
+#ifndef EPOLL_SERVER_H
+#define EPOLL_SERVER_H
+
+#include "constants.h"
+#include "core/mechanic.h"
+#include "core/logger.h"
+#include "core/json_reader.h"
+#include "core/json_writer.h"
+#include "core/wire_format.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+
+// Сервер механики без цикла событий Qt (server_runner с CONFIG+=epoll_server,
+// только Linux). Протокол, логи и файлы результатов те же, что у TcpServer и
+// ClientWrapper. Игра - EpollMatch, цикл событий одной игры - EpollServer,
+// несколько игр в одном процессе - MatchServer (match_server.h). Сокеты читаются в edge-triggered режиме до EAGAIN, у каждого
+// клиента свой timerfd со сроком ответа в микросекундах вместо общего таймера
+// на 100 мс, у сокетов выставлен TCP_NODELAY: ответ стратегии не ждёт ни
+// Nagle, ни очереди сигналов. Сообщения уходят через sendmsg прямо из
+// SharedBuffer, который держит и дамп, а недошедшие копятся очередью ссылок.
+
+inline long long monotonic_us() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+// как QString::left: не больше count символов, UTF-8 не разрезается
+inline std::string utf8_left(const std::string &value, int count) {
+    size_t pos = 0;
+    for (int chars = 0; pos < value.size() && chars < count; chars++) {
+        pos++;
+        while (pos < value.size() && (value[pos] & 0xC0) == 0x80) {
+            pos++;
+        }
+    }
+    return value.substr(0, pos);
+}
+
+
+class EpollMatch;
+class EpollClient;
+
+// то, на что указывает data.ptr события epoll
+struct EpollWatch
+{
+    enum Kind {
+        LISTEN, WAKE, CONNECT_TIMER, SOCKET, TIMER
+    };
+
+    Kind kind;
+    EpollMatch *match;
+    EpollClient *client;
+};
+
+inline void epoll_watch(int epoll_fd, int fd, uint32_t flags, EpollWatch *watch) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = flags;
+    event.data.ptr = watch;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+// неблокирующий слушающий сокет; -1, если порт занят
+inline int epoll_listen(const std::string &host, int port) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+class EpollClient
+{
+public:
+    const GameConfig config;
+    int fd;
+    int timer_fd;
+    Logger *logger;
+    Logger *dump_logger;
+    EpollWatch socket_watch;
+    EpollWatch timer_watch;
+    std::string solution_id;
+    int player_id;
+    bool is_ready;
+    bool answered;
+    bool is_active;
+
+    std::string got_data;
+    std::deque<SharedBuffer> out_queue; // ещё не ушедшие в сокет сообщения
+    size_t out_offset;                  // сколько байт первого из них ушло
+    SharedBufferSlot state_message;
+    SharedBufferSlot wire_message;
+    StateProtocol protocol;
+    JsonDeltaState delta;
+
+    // timeouts implementation, мкс
+    bool waiting;
+    long long wait_start;
+    long long sum_waiting;
+
+public:
+    explicit EpollClient(int _fd, int _timer_fd, EpollMatch *match, const GameConfig &_config, bool async_logs) :
+        config(_config),
+        fd(_fd),
+        timer_fd(_timer_fd),
+        logger(new Logger(config)),
+        dump_logger(new Logger(config)),
+        socket_watch{EpollWatch::SOCKET, match, this},
+        timer_watch{EpollWatch::TIMER, match, this},
+        player_id(0),
+        is_ready(false),
+        answered(false),
+        is_active(false),
+        out_offset(0),
+        protocol(PROTOCOL_JSON),
+        delta(config.BASE_TICK),
+        waiting(false),
+        wait_start(0),
+        sum_waiting(0)
+    {
+        dump_logger->set_async(async_logs);
+    }
+
+    virtual ~EpollClient() {
+        close_socket();
+        if (timer_fd >= 0) close(timer_fd);
+        if (logger) delete logger;
+        if (dump_logger) delete dump_logger;
+    }
+
+    void close_socket() {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    std::string describe() const {
+        return "player " + std::to_string(player_id) + " (solution " + solution_id + ")";
+    }
+
+    // срок ответа: RESP_TIMEOUT на тик, но не дальше остатка SUM_RESP_TIMEOUT
+    void start_waiting() {
+        waiting = true;
+        wait_start = monotonic_us();
+        long long deadline = wait_start + config.RESP_TIMEOUT * 1000000LL;
+        long long sum_deadline = wait_start + config.SUM_RESP_TIMEOUT * 1000000LL - sum_waiting;
+        arm_timer(std::min(deadline, sum_deadline));
+    }
+
+    // true - суммарное ожидание исчерпано
+    bool accumulate_wait() {
+        if (waiting) {
+            sum_waiting += monotonic_us() - wait_start;
+            waiting = false;
+            arm_timer(0);
+        }
+        return sum_waiting > config.SUM_RESP_TIMEOUT * 1000000LL;
+    }
+
+    bool deadline_passed() const {
+        long long elapsed = monotonic_us() - wait_start;
+        return elapsed >= config.RESP_TIMEOUT * 1000000LL ||
+               sum_waiting + elapsed >= config.SUM_RESP_TIMEOUT * 1000000LL;
+    }
+
+    void arm_timer(long long deadline_us) {
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        if (deadline_us > 0) {
+            spec.it_value.tv_sec = deadline_us / 1000000;
+            spec.it_value.tv_nsec = (deadline_us % 1000000) * 1000;
+        }
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+    }
+
+    // false - сокет сломан
+    bool write(const SharedBuffer &message) {
+        if (fd < 0) {
+            return false;
+        }
+        out_queue.push_back(message);
+        return flush();
+    }
+
+    // Отправляет очередь одним sendmsg на IOV_MAX_SENT сообщений, без склейки.
+    // Что не влезло в сокет, дошлётся по EPOLLOUT.
+    bool flush() {
+        const size_t IOV_MAX_SENT = 64;
+        iovec iov[IOV_MAX_SENT];
+        while (fd >= 0 && ! out_queue.empty()) {
+            size_t count = std::min(out_queue.size(), IOV_MAX_SENT);
+            for (size_t I = 0; I < count; I++) {
+                const std::string &message = *out_queue[I];
+                size_t skip = I == 0? out_offset : 0;
+                iov[I].iov_base = const_cast<char*>(message.data()) + skip;
+                iov[I].iov_len = message.size() - skip;
+            }
+            msghdr header;
+            std::memset(&header, 0, sizeof(header));
+            header.msg_iov = iov;
+            header.msg_iovlen = count;
+            ssize_t sent = sendmsg(fd, &header, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            size_t left = sent;
+            while (left > 0 && ! out_queue.empty()) {
+                size_t size = out_queue.front()->size() - out_offset;
+                if (left < size) {
+                    out_offset += left;
+                    break;
+                }
+                left -= size;
+                out_queue.pop_front();
+                out_offset = 0;
+            }
+        }
+        return true;
+    }
+
+    bool send_config() {
+        JsonWriter::write_config(state_message.acquire(), config);
+        SharedBuffer message = state_message.get();
+        bool sent;
+        if (protocol == PROTOCOL_BINARY) {
+            WireWriter::write_config(wire_message.acquire(), config);
+            sent = write(wire_message.get());
+        } else {
+            sent = write(message);
+        }
+        dump_logger->write_raw(0, message);
+        return sent;
+    }
+
+    bool send_state(const PlayerArray &fragments, const CircleArray &visibles, int tick, JsonObjectCache &cache) {
+        bool sent;
+        if (protocol == PROTOCOL_DELTA) {
+            delta.write_state(state_message.acquire(), fragments, visibles, cache);
+            sent = write(state_message.get());
+        } else if (protocol == PROTOCOL_BINARY) {
+            WireWriter::write_state(wire_message.acquire(), tick, fragments, visibles);
+            sent = write(wire_message.get());
+        } else {
+            cache.write_state(state_message.acquire(), fragments, visibles);
+            sent = write(state_message.get());
+        }
+        // в дамп - та же память, что ушла в сокет; JSON для дампа двоичного
+        // клиента собирает из кадра писатель лога
+        if (protocol == PROTOCOL_BINARY) {
+            dump_logger->write_wire_state(tick + 1, wire_message.get());
+        } else {
+            dump_logger->write_raw(tick + 1, state_message.get());
+        }
+        answered = false;
+        start_waiting();
+        return sent;
+    }
+};
+
+
+// Одна игра: подключения её клиентов, таймеры и механика. События приходят
+// из цикла, в epoll которого она зарегистрировала свои дескрипторы.
+class EpollMatch
+{
+protected:
+    const GameConfig config;
+    std::string result_path;
+    std::string match_id;       // пусто - единственная игра процесса
+
+    int epoll_fd;
+    int connect_timer_fd;
+    EpollWatch connect_watch;
+    Mechanic *mechanic;
+    std::vector<EpollClient*> clients;
+    // JSON объектов текущего тика, общий для сообщений всех клиентов
+    JsonObjectCache state_cache;
+
+    int ready_player_id;
+    int client_cnt;
+    int current_tick;
+    bool game_active;
+    bool finished;
+
+public:
+    explicit EpollMatch(int _epoll_fd, const std::string &_res_path, int _client_cnt, const GameConfig &_config,
+                        const std::string &_match_id="") :
+        config(_config),
+        result_path(_res_path),
+        match_id(_match_id),
+        epoll_fd(_epoll_fd),
+        connect_timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+        connect_watch{EpollWatch::CONNECT_TIMER, this, NULL},
+        mechanic(new Mechanic(config)),
+        ready_player_id(1),
+        client_cnt(_client_cnt),
+        current_tick(0),
+        game_active(false),
+        finished(false)
+    {
+        // Лог игры пишет отдельный поток, чтобы тик не ждал диска и zlib. Играм
+        // MatchServer своих писателей не положено: их сотни, и логи пишет
+        // рабочий поток игры.
+        mechanic->get_logger()->set_async(match_id.empty());
+        mechanic->get_logger()->set_index(true);
+        // точный лог для replay_verify: в текстовом числа округлены
+        mechanic->get_logger()->set_binary(config.BINARY_LOG != 0);
+
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = CONNECT_TIMEOUT;
+        timerfd_settime(connect_timer_fd, 0, &spec, NULL);
+        epoll_watch(epoll_fd, connect_timer_fd, EPOLLIN, &connect_watch);
+    }
+
+    virtual ~EpollMatch() {
+        for (EpollClient *client : clients) {
+            if (client) delete client;
+        }
+        if (mechanic) delete mechanic;
+        if (connect_timer_fd >= 0) close(connect_timer_fd);
+    }
+
+    bool is_finished() const {
+        return finished;
+    }
+
+    bool accepts_clients() const {
+        return ! finished && int(clients.size()) < client_cnt;
+    }
+
+    // data - уже прочитанное из сокета (в MatchServer - строка подключения)
+    void add_client(int fd, const std::string &data="") {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+        EpollClient *client = new EpollClient(fd, timer_fd, this, config, match_id.empty());
+        clients.push_back(client);
+        client->got_data = data;
+        epoll_watch(epoll_fd, fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, &client->socket_watch);
+        epoll_watch(epoll_fd, timer_fd, EPOLLIN, &client->timer_watch);
+        if (! data.empty()) {
+            read_data(client);
+        }
+    }
+
+    void dispatch(const EpollWatch *watch, uint32_t events) {
+        if (finished) {
+            return;
+        }
+        if (watch->kind == EpollWatch::CONNECT_TIMER) {
+            uint64_t expirations;
+            if (read(connect_timer_fd, &expirations, sizeof(expirations)) > 0 && ! game_active && ! finished) {
+                say("Waiting expired");
+                finish();
+            }
+            return;
+        }
+        EpollClient *client = watch->client;
+        if (watch->kind == EpollWatch::TIMER) {
+            client_timer(client);
+            return;
+        }
+        if (client->fd < 0) {
+            return;
+        }
+        if (events & EPOLLOUT) {
+            if (! client->flush()) {
+                client_disconnected(client);
+                return;
+            }
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            read_data(client);
+        }
+    }
+
+protected:
+    // строка в stderr целиком: игры нескольких потоков не перемешивают вывод
+    void say(const std::string &message) {
+        std::string line = match_id.empty()? message : "[" + match_id + "] " + message;
+        std::cerr << line + "\n" << std::flush;
+    }
+
+    // в MatchServer процесс живёт дальше: сокеты закрываются сразу
+    void finish() {
+        finished = true;
+        if (! match_id.empty()) {
+            for (EpollClient *client : clients) {
+                client->close_socket();
+                client->arm_timer(0);
+            }
+        }
+    }
+
+    // edge-triggered: читаем всё, что есть, и разбираем все целые сообщения
+    void read_data(EpollClient *client) {
+        bool closed = false;
+        char buffer[65536];
+        while (true) {
+            ssize_t size = recv(client->fd, buffer, sizeof(buffer), 0);
+            if (size > 0) {
+                client->got_data.append(buffer, size);
+                continue;
+            }
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            closed = size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+        while (client->fd >= 0) {
+            bool parsed = client->is_ready && client->protocol == PROTOCOL_BINARY?
+                        read_frame(client) : read_line(client);
+            if (! parsed) break;
+        }
+        if (closed && client->fd >= 0) {
+            client_disconnected(client);
+        }
+    }
+
+    // false - целой строки ещё нет
+    bool read_line(EpollClient *client) {
+        std::string &data = client->got_data;
+        size_t end = data.find('\n');
+        std::string line;
+        if (end == std::string::npos) {
+            if (data.size() < size_t(MAX_RESP_LEN)) {
+                return false;
+            }
+            line = data.substr(0, MAX_RESP_LEN);
+            data.erase(0, MAX_RESP_LEN);
+        } else {
+            line = data.substr(0, std::min(end + 1, size_t(MAX_RESP_LEN)));
+            data.erase(0, end + 1);
+        }
+        if (client->answered) {
+            return true;
+        }
+        client->answered = true;
+        if (client->accumulate_wait()) {
+            sum_expired(client);
+            return true;
+        }
+
+        JsonValue json;
+        if (! parse_answer(client, line, json)) {
+            return true;
+        }
+        if (! client->is_ready) {
+            handshake(client, json);
+            return true;
+        }
+
+        std::string dump;
+        JsonReader::write(dump, json);
+        client->dump_logger->write_raw_with_old_tick(dump + "\n");
+        if (json.contains("error")) {
+            client_error(client, utf8_left(json.value("error").to_string(), MAX_DEBUG_LEN));
+            return true;
+        }
+        if (! json.contains("X") || ! json.contains("Y")) {
+            client_error(client, "No required key 'X' or 'Y'");
+            return true;
+        }
+
+        Direct result(json.value("X").to_double(), json.value("Y").to_double());
+        result.split = json.value("Split").to_bool();
+        result.eject = json.value("Eject").to_bool();
+        const JsonValue &sprite = json.value("Sprite");
+        client_responsed(client, result, json.value("Debug").to_string(),
+                         sprite.value("Id").to_string(), sprite.value("S").to_string());
+        return true;
+    }
+
+    bool parse_answer(EpollClient *client, std::string &line, JsonValue &json) {
+        if (line.size() < 3) {
+            client_error(client, "Incorrect response (len < 3)");
+            return false;
+        }
+        if (line[line.size() - 1] == '\n') {
+            line.resize(line.size() - 1);
+        }
+        JsonReader reader(line.data(), line.size());
+        if (! reader.parse(json)) {
+            client_error(client, "Incorrect response (" + reader.get_error() + ")");
+            return false;
+        }
+        if (! json.is_object() || json.object.empty()) {
+            client_error(client, "Can't parse json: " + line);
+            return false;
+        }
+        return true;
+    }
+
+    void handshake(EpollClient *client, const JsonValue &json) {
+        if (! json.contains("solution_id")) {
+            client_error(client, "No required key 'solution_id'");
+            return;
+        }
+        if (json.contains("protocol")) {
+            std::string name = json.value("protocol").to_string();
+            if (name == "delta") {
+                client->protocol = PROTOCOL_DELTA;
+            } else if (name == "binary") {
+                client->protocol = PROTOCOL_BINARY;
+            } else if (name != "json") {
+                client_error(client, "Unknown protocol '" + name + "'");
+                return;
+            }
+        }
+        client->solution_id = json.value("solution_id").to_string();
+        client->logger->init_file(client->solution_id, DEBUG_FILE);
+        client->dump_logger->init_file(client->solution_id, DUMP_FILE);
+        client->is_ready = true;
+        client_ready(client);
+    }
+
+    // Двоичный протокол (core/wire_format.h), как ClientWrapper::read_frames
+    bool read_frame(EpollClient *client) {
+        std::string &data = client->got_data;
+        uint32_t size;
+        if (! WireReader::frame_size(data.data(), data.size(), size)) {
+            return false;
+        }
+        if (size > uint32_t(MAX_RESP_LEN)) {
+            // границу следующего кадра уже не найти
+            data.clear();
+            client_error(client, "Incorrect response (frame is too long)");
+            drop_client(client);
+            return false;
+        }
+        if (data.size() < WIRE_LENGTH_SIZE + size) {
+            return false;
+        }
+        WireCommand command;
+        bool parsed = WireReader(data.data() + WIRE_LENGTH_SIZE, size).read_command(command);
+        data.erase(0, WIRE_LENGTH_SIZE + size);
+        if (client->answered) {
+            return true;
+        }
+        client->answered = true;
+        if (client->accumulate_wait()) {
+            sum_expired(client);
+            return true;
+        }
+        if (! parsed) {
+            client_error(client, "Incorrect response (broken frame)");
+            return true;
+        }
+        client->dump_logger->write_raw_with_old_tick(command.to_json());
+        if (command.kind == WIRE_ERROR) {
+            client_error(client, utf8_left(command.debug, MAX_DEBUG_LEN));
+            return true;
+        }
+        Direct result(command.x, command.y);
+        result.split = (command.flags & WIRE_SPLIT) != 0;
+        result.eject = (command.flags & WIRE_EJECT) != 0;
+        client_responsed(client, result, command.debug, command.sprite_id, command.sprite);
+        return true;
+    }
+
+    void client_timer(EpollClient *client) {
+        uint64_t expirations;
+        if (read(client->timer_fd, &expirations, sizeof(expirations)) <= 0) {
+            return;
+        }
+        // таймер мог сработать в одной пачке событий с ответом
+        if (! client->waiting || ! client->is_active || ! client->deadline_passed()) {
+            return;
+        }
+        if (client->accumulate_wait()) {
+            sum_expired(client);
+            return;
+        }
+        client_error(client, RESP_EXPIRED.toStdString());
+        drop_client(client);
+    }
+
+    void sum_expired(EpollClient *client) {
+        client->is_active = false;
+        client_error(client, SUM_RESP_EXPIRED.toStdString());
+        drop_client(client);
+    }
+
+    void drop_client(EpollClient *client) {
+        client->is_active = false;
+        if (client->fd >= 0) {
+            client_disconnected(client);
+        }
+    }
+
+    void client_disconnected(EpollClient *client) {
+        client->close_socket();
+        client->arm_timer(0);
+        say("client disconnected " + client->describe());
+        if (client->is_active) {
+            client->is_active = false;
+            client->logger->write_error(current_tick, client->player_id, CLIENT_DISCONNECTED.toStdString());
+        }
+        if (get_active_count() == 0 && game_active) {
+            cancel_game();
+        } else {
+            check_answers();
+        }
+    }
+
+    int get_active_count() {
+        int count = 0;
+        for (EpollClient *client : clients) {
+            if (client->is_active) count++;
+        }
+        return count;
+    }
+
+    int get_ready_clients_count() {
+        int count = 0;
+        for (EpollClient *client : clients) {
+            if (client->is_ready) count++;
+        }
+        return count;
+    }
+
+    int get_answered_clients_count() {
+        int count = 0;
+        for (EpollClient *client : clients) {
+            if (client->answered && client->is_active) count++;
+        }
+        return count;
+    }
+
+    // все ещё подключённые ответили; без них игру заканчивает client_disconnected
+    void check_answers() {
+        int active = get_active_count();
+        if (game_active && active > 0 && get_answered_clients_count() == active) {
+            next_tick();
+        }
+    }
+
+    void client_ready(EpollClient *client) {
+        client->player_id = ready_player_id;
+        client->is_active = true;
+
+        ready_player_id++;
+        if (get_ready_clients_count() == client_cnt) {
+            start_game();
+        }
+    }
+
+    void start_game() {
+        game_active = true;
+        itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        timerfd_settime(connect_timer_fd, 0, &spec, NULL);
+
+        std::string seed = config.SEED;
+        say("starting game " + seed);
+        mechanic->init_objects(seed, [] (Player*) -> Strategy* {
+            return NULL;
+        });
+
+        Logger *ml = mechanic->get_logger();
+        for (EpollClient *client : clients) {
+            // independent from is_canceled
+            ml->write_solution_id(client->player_id, client->solution_id);
+        }
+        for (EpollClient *client : clients) {
+            if (client->is_active && ! client->send_config()) {
+                client_error(client, "Fatal error: can't send config");
+            }
+        }
+        broadcast_state();
+    }
+
+    void broadcast_state() {
+        state_cache.clear();
+        for (EpollClient *client : clients) {
+            if (client->is_active) {
+                PlayerArray fragments = mechanic->get_players_by_id(client->player_id);
+                CircleArray visibles = mechanic->get_visibles(fragments);
+                if (! client->send_state(fragments, visibles, current_tick, state_cache)) {
+                    client->logger->write_error(current_tick, client->player_id, "Fatal error: can't send state");
+                    // разрыв придёт событием epoll
+                    shutdown(client->fd, SHUT_RDWR);
+                }
+            }
+        }
+    }
+
+    void client_responsed(EpollClient *client, const Direct &direct, const std::string &msg,
+                          const std::string &player, const std::string &sprite_msg) {
+        if (! msg.empty()) {
+            client->logger->write_debug(current_tick, client->player_id, utf8_left(msg, MAX_DEBUG_LEN));
+        }
+        if (! player.empty() && ! sprite_msg.empty()) {
+            client->logger->write_to_sprite(current_tick, client->player_id,
+                                            utf8_left(player, MAX_ID_LEN), utf8_left(sprite_msg, MAX_DEBUG_LEN));
+        }
+        mechanic->apply_direct_for(client->player_id, direct);
+        check_answers();
+    }
+
+    void client_error(EpollClient *client, const std::string &msg) {
+        client->logger->write_error(current_tick, client->player_id, msg);
+        check_answers();
+    }
+
+    void next_tick() {
+        bool is_paused = false;
+        int tick = mechanic->tickEvent(is_paused);
+        if (tick % 100 == 0 && match_id.empty()) {
+            std::cerr << "tick " << tick << "\r";
+        }
+        current_tick = tick;
+        if (tick < config.GAME_TICKS && !mechanic->known()) {
+            broadcast_state();
+        }
+        else {
+            say("Successfully played");
+            cancel_game();
+        }
+    }
+
+    void cancel_game() {
+        for (EpollClient *client : clients) {
+            client->logger->flush();
+            client->dump_logger->flush();
+        }
+        game_active = false;
+        Logger *ml = mechanic->get_logger();
+        ml->rewrite_game_ticks(current_tick);
+        ml->flush();
+
+        write_scores();
+        write_result();
+        finish();
+    }
+
+    // файлы результатов - байт в байт как у TcpServer (QJsonDocument::Compact)
+    static void append_file(std::string &out, const std::string &filename, bool is_private, const std::string &location) {
+        out += '{';
+        JsonWriter::append_key(out, "filename", true); JsonWriter::append_string(out, filename);
+        JsonWriter::append_key(out, "is_private"); out += is_private? "true" : "false";
+        JsonWriter::append_key(out, "location"); JsonWriter::append_string(out, location);
+        out += '}';
+    }
+
+    void write_scores() {
+        std::map<std::string, int> scores;
+        for (EpollClient *client : clients) {
+            scores[client->solution_id] = mechanic->get_score_for(client->player_id);
+        }
+        std::string result = "{";
+        for (const auto &score : scores) {
+            if (result.size() > 1) result += ',';
+            JsonWriter::append_string(result, score.first);
+            result += ':';
+            JsonWriter::append_number(result, score.second);
+        }
+        result += '}';
+
+        std::ofstream file(config.LOG_DIR + SCORES_FILE.toStdString(), std::ios::binary | std::ios::trunc);
+        file << result;
+    }
+
+    void write_result() {
+        std::string result = "{";
+        JsonWriter::append_key(result, DEBUG_JSON_KEY.toStdString().c_str(), true);
+        result += '[';
+        for (size_t I = 0; I < clients.size(); I++) {
+            if (I > 0) result += ',';
+            Logger *cl = clients[I]->logger;
+            append_file(result, cl->get_file_name() + ".gz", true, cl->get_path() + ".gz");
+            result += ',';
+            cl = clients[I]->dump_logger;
+            append_file(result, cl->get_file_name() + ".gz", true, cl->get_path() + ".gz");
+        }
+        result += ']';
+        JsonWriter::append_key(result, SCORES_JSON_KEY.toStdString().c_str());
+        append_file(result, SCORES_FILE.toStdString(), false, config.LOG_DIR + SCORES_FILE.toStdString());
+        Logger *ml = mechanic->get_logger();
+        JsonWriter::append_key(result, MAIN_JSON_KEY.toStdString().c_str());
+        append_file(result, ml->get_file_name() + ".gz", false, ml->get_path() + ".gz");
+        result += '}';
+
+        std::ofstream file(result_path, std::ios::binary | std::ios::trunc);
+        file << result;
+    }
+};
+
+
+// Цикл событий одной игры: как TcpServer, процесс завершается вместе с ней
+class EpollServer
+{
+protected:
+    int epoll_fd;
+    int listen_fd;
+    EpollWatch listen_watch;
+    EpollMatch *match;
+
+public:
+    explicit EpollServer(const std::string &res_path, int client_cnt, const GameConfig &config) :
+        epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+        listen_fd(-1),
+        listen_watch{EpollWatch::LISTEN, NULL, NULL},
+        match(new EpollMatch(epoll_fd, res_path, client_cnt, config))
+    {}
+
+    virtual ~EpollServer() {
+        if (match) delete match;
+        if (listen_fd >= 0) close(listen_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+    }
+
+    void bind(const std::string &host, int port) {
+        std::cerr << "waiting for clients on " << host << ":" << port << std::endl;
+        listen_fd = epoll_listen(host, port);
+        if (listen_fd < 0) {
+            std::cerr << "Already bound to that port. listen() failed" << std::endl;
+            return;
+        }
+        epoll_watch(epoll_fd, listen_fd, EPOLLIN | EPOLLET, &listen_watch);
+    }
+
+    // до конца игры или истечения CONNECT_TIMEOUT
+    int exec() {
+        const int MAX_EVENTS = 64;
+        epoll_event events[MAX_EVENTS];
+        while (! match->is_finished()) {
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return 1;
+            }
+            for (int I = 0; I < count && ! match->is_finished(); I++) {
+                const EpollWatch *watch = static_cast<const EpollWatch*>(events[I].data.ptr);
+                if (watch->kind == EpollWatch::LISTEN) {
+                    accept_clients();
+                } else {
+                    watch->match->dispatch(watch, events[I].events);
+                }
+            }
+        }
+        return 0;
+    }
+
+protected:
+    // лишние подключения остаются в очереди, как у QTcpServer
+    void accept_clients() {
+        while (match->accepts_clients()) {
+            int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            match->add_client(fd);
+        }
+    }
+};
+
+#endif // EPOLL_SERVER_H
@@ -4,10 +4,10 @@
 
 int main(int argc, char *argv[]) {
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    Constants::initialize(env);
+    GameConfig config = load_config(env);
 
     QApplication a(argc, argv);
-    MainWindow window;
+    MainWindow window(config);
     window.show();
     return a.exec();
 }
@@ -17,21 +17,15 @@ TEMPLATE = app
 
 SOURCES += local_runner.cpp
 
+include(core/core.pri)
+
 HEADERS  += mainwindow.h \
-    mechanic.h \
-    logger.h \
-    entities/food.h \
-    entities/circle.h \
     constants.h \
-    entities/virus.h \
-    entities/player.h \
-    strategies/strategy.h \
+    adapters/json.h \
+    adapters/painter.h \
     strategies/bymouse.h \
-    entities/ejection.h \
     strategymodal.h \
     strategies/custom.h
 
 FORMS    += mainwindow.ui \
     strategymodal.ui
-
-LIBS += -lz
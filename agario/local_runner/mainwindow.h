@@ -10,7 +10,8 @@
 
 #include "constants.h"
 #include "strategymodal.h"
-#include "mechanic.h"
+#include "core/mechanic.h"
+#include "adapters/painter.h"
 #include "ui_mainwindow.h"
 
 namespace Ui {
@@ -23,6 +24,8 @@ class MainWindow : public QMainWindow
 
 private:
     Ui::MainWindow *ui;
+    // параметры из окружения; игра по логу берёт их из заголовка лога
+    const GameConfig config;
     Mechanic *mechanic = nullptr;
     StrategyModal *sm;
     QMessageBox *mbox;
@@ -32,10 +35,11 @@ private:
 
     QMap<int, bool> player_vision;
 public:
-    explicit MainWindow(QWidget *parent = 0) :
+    explicit MainWindow(const GameConfig &_config, QWidget *parent = 0) :
         QMainWindow(parent),
         ui(new Ui::MainWindow),
-        mechanic(new Mechanic),
+        config(_config),
+        mechanic(new Mechanic(config)),
         sm(new StrategyModal),
         mbox(new QMessageBox),
         timerId(-1),
@@ -45,10 +49,10 @@ public:
         this->setMouseTracking(true);
         this->setFixedSize(this->geometry().width(), this->geometry().height());
 
-        if (Constants::instance().SEED.isEmpty()) {
-            ui->txt_seed->setText(Constants::generate_seed());
+        if (config.SEED.empty()) {
+            ui->txt_seed->setText(QString::fromStdString(GameConfig::generate_seed()));
         } else {
-            ui->txt_seed->setText(Constants::instance().SEED);
+            ui->txt_seed->setText(QString::fromStdString(config.SEED));
         }
 
         ui->tableWidget->setSelectionMode(QAbstractItemView::NoSelection);
@@ -88,29 +92,35 @@ public slots:
             is_paused = !is_paused;
             return;
         }
-        timerId = startTimer(Constants::instance().TICK_MS);
-
-        QSharedPointer<ReplayLog> replay_log = nullptr;
+        GameConfig game_config = config;
+        std::shared_ptr<ReplayLog> replay_log = nullptr;
         auto replay_log_txt = ui->txt_replay_log->text().trimmed();
         if (!replay_log_txt.isEmpty()) {
-            replay_log = QSharedPointer<ReplayLog>(new ReplayLog(replay_log_txt));
-            Constants::initialize(replay_log->env());
+            replay_log = std::make_shared<ReplayLog>(replay_log_txt.toStdString());
+            QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+            for (auto &param : replay_log->params()) {
+                env.insert(QString::fromStdString(param.first), QString::fromStdString(param.second));
+            }
+            game_config = load_config(env);
         }
+        timerId = startTimer(game_config.TICK_MS);
 
         std::string seed = ui->txt_seed->text().toStdString();
 
         ui->tableWidget->setSortingEnabled(false);
         ui->tableWidget->setRowCount(0);
 
-        mechanic = new Mechanic();
+        mechanic = new Mechanic(game_config);
+        mechanic->get_logger()->set_autoflush(true);
+        mechanic->get_logger()->set_async(true);
         if (replay_log != nullptr) {
             mechanic->set_replay_log(replay_log);
         }
-        mechanic->init_objects(seed, [this, replay_log] (Player *player) {
+        mechanic->init_objects(seed, [this, replay_log, &game_config] (Player *player) {
             int pId = player->getId();
             player->set_color(sm->get_color(pId));
 
-            Strategy *strategy = sm->get_strategy(pId);
+            Strategy *strategy = sm->get_strategy(pId, game_config);
             Custom *custom = dynamic_cast<Custom*>(strategy);
             if (custom != NULL) {
                 connect(custom, SIGNAL(error(QString)), this, SLOT(on_error(QString)));
@@ -206,8 +216,8 @@ public slots:
         QSvgGenerator generator;
         generator.setFileName("/tmp/game.svg");
         generator.setSize(QSize(
-                    Constants::instance().GAME_WIDTH,
-                    Constants::instance().GAME_HEIGHT));
+                    mechanic->get_config().GAME_WIDTH,
+                    mechanic->get_config().GAME_HEIGHT));
         QPainter painter;
         painter.begin(&generator);
         paint_on(painter);
@@ -220,10 +230,10 @@ public:
         ui->txt_ticks->setText(QString::number(tick));
         this->update();
 
-        if (tick % Constants::instance().BASE_TICK == 0 && tick != 0) {
+        if (tick % mechanic->get_config().BASE_TICK == 0 && tick != 0) {
             update_score();
         }
-        if (tick % Constants::instance().GAME_TICKS == 0 && tick != 0) {
+        if (tick % mechanic->get_config().GAME_TICKS == 0 && tick != 0) {
             finish_game();
         }
     }
@@ -234,8 +244,8 @@ public:
         painter.translate(ui->viewport->x(), ui->viewport->y());
         painter.fillRect(ui->viewport->rect(), QBrush(Qt::white));
         painter.setClipRect(ui->viewport->rect());
-        painter.scale((qreal) ui->viewport->width() / Constants::instance().GAME_WIDTH,
-                      (qreal) ui->viewport->height() / Constants::instance().GAME_HEIGHT);
+        painter.scale((qreal) ui->viewport->width() / mechanic->get_config().GAME_WIDTH,
+                      (qreal) ui->viewport->height() / mechanic->get_config().GAME_HEIGHT);
         paint_on(painter);
     }
 
@@ -243,7 +253,7 @@ public:
         bool show_speed = ui->cbx_speed->isChecked();
         bool show_cmd = ui->cbx_forces->isChecked();
         bool show_fogs = ui->cbx_fog->isChecked();
-        mechanic->paintEvent(painter, show_speed, show_fogs, show_cmd, player_vision);
+        paint_world(painter, mechanic, show_speed, show_fogs, show_cmd, player_vision);
     }
 
     void timerEvent(QTimerEvent *event) {
@@ -264,27 +274,37 @@ public:
     }
 
     void mousePressEvent(QMouseEvent *event) {
-        int x = (event->x() - ui->viewport->x()) / ((qreal) ui->viewport->width() / Constants::instance().GAME_WIDTH);
-        int y = (event->y() - ui->viewport->y()) / ((qreal) ui->viewport->height() / Constants::instance().GAME_HEIGHT);
-        mechanic->mouseMoveEvent(x, y);
+        int x = (event->x() - ui->viewport->x()) / ((qreal) ui->viewport->width() / mechanic->get_config().GAME_WIDTH);
+        int y = (event->y() - ui->viewport->y()) / ((qreal) ui->viewport->height() / mechanic->get_config().GAME_HEIGHT);
+        for (Strategy *strategy : mechanic->get_strategies()) {
+            ByMouse *by_mouse = dynamic_cast<ByMouse*>(strategy);
+            if (by_mouse != NULL) {
+                by_mouse->set_mouse(x, y);
+            }
+        }
     }
 
     void keyPressEvent(QKeyEvent *event) {
         if (event->key() == Qt::Key_Space) {
             pause_and_step_game();
         } else {
-            mechanic->keyPressEvent(event);
+            for (Strategy *strategy : mechanic->get_strategies()) {
+                ByMouse *by_mouse = dynamic_cast<ByMouse*>(strategy);
+                if (by_mouse != NULL) {
+                    by_mouse->set_key(event);
+                }
+            }
         }
     }
 
     void update_score() {
-        QMap<int, int> scores = mechanic->get_scores();
+        std::map<int, int> scores = mechanic->get_scores();
 
         ui->tableWidget->setSortingEnabled(false);
 
         for (int row = 0; row < ui->tableWidget->rowCount(); ++row) {
             int pId = ui->tableWidget->item(row, 0)->data(Qt::DisplayRole).toInt();
-            ui->tableWidget->item(row, 2)->setData(Qt::DisplayRole, scores.value(pId));
+            ui->tableWidget->item(row, 2)->setData(Qt::DisplayRole, scores[pId]);
         }
 
          ui->tableWidget->setSortingEnabled(true);
@@ -0,0 +1,430 @@
+#ifndef MATCH_SERVER_H
+#define MATCH_SERVER_H
+
+#include "epoll_server.h"
+
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cctype>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+// Много игр в одном процессе на одном порту (server_runner с CONFIG+=epoll_server
+// и MATCH_THREADS). Клиент называет игру в строке подключения:
+// {"solution_id": "...", "match_id": "..."}. Первые CLIENT_CNT клиентов с одним
+// match_id играют вместе, следующий с тем же id начинает новую игру (и пишет
+// логи поверх прежней: id лучше не повторять).
+//
+// Приёмный поток дочитывает строку подключения и отдаёт сокет рабочему потоку
+// игры. Рабочих потоков MATCH_THREADS, у каждого свой epoll и свои игры;
+// новая игра достаётся потоку, у которого меньше всего незакончившихся игр. Игра ждёт ответов почти всё время, поэтому
+// поток на игру не нужен, а задачи пула на каждое событие потребовали бы
+// блокировок вокруг механики. Логи и результат игры пишутся в LOG_DIR/match_id/.
+class MatchWorker
+{
+public:
+    // подключение, переданное из приёмного потока
+    struct Handoff {
+        std::string match_id;
+        int fd;
+        std::string data;           // прочитанное вместе со строкой подключения
+        GameConfig config;          // если игру придётся создать
+        std::string result_path;
+        bool new_match;             // первый клиент игры: приёмный поток уже учёл её в match_count
+    };
+
+protected:
+    int epoll_fd;
+    int wake_fd;
+    EpollWatch wake_watch;
+    int client_cnt;
+
+    std::mutex handoffs_lock;
+    std::vector<Handoff> handoffs;
+
+    std::vector<EpollMatch*> matches;
+    std::map<std::string, EpollMatch*> open_matches;   // ещё набирают клиентов
+    // незакончившиеся игры вместе с отданными, но ещё не созданными; по нему
+    // приёмный поток выбирает поток для новой игры
+    std::atomic<int> match_count;
+    std::atomic<bool> stopping;
+    std::thread thread;
+
+public:
+    explicit MatchWorker(int _client_cnt) :
+        epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+        wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        wake_watch{EpollWatch::WAKE, NULL, NULL},
+        client_cnt(_client_cnt),
+        match_count(0),
+        stopping(false)
+    {
+        epoll_watch(epoll_fd, wake_fd, EPOLLIN, &wake_watch);
+        thread = std::thread(&MatchWorker::run, this);
+    }
+
+    // недоигранные игры обрываются без записи результатов
+    virtual ~MatchWorker() {
+        stopping = true;
+        wake();
+        thread.join();
+        for (EpollMatch *match : matches) {
+            delete match;
+        }
+        for (Handoff &handoff : handoffs) {
+            close(handoff.fd);
+        }
+        close(wake_fd);
+        close(epoll_fd);
+    }
+
+    int get_match_count() const {
+        return match_count;
+    }
+
+    void hand_off(Handoff &&handoff) {
+        if (handoff.new_match) {
+            match_count++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(handoffs_lock);
+            handoffs.push_back(std::move(handoff));
+        }
+        wake();
+    }
+
+protected:
+    void wake() {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            // счётчик eventfd переполнен - поток и так будет разбужен
+        }
+    }
+
+    void run() {
+        const int MAX_EVENTS = 256;
+        epoll_event events[MAX_EVENTS];
+        while (! stopping) {
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int I = 0; I < count && ! stopping; I++) {
+                const EpollWatch *watch = static_cast<const EpollWatch*>(events[I].data.ptr);
+                if (watch->kind == EpollWatch::WAKE) {
+                    take_handoffs();
+                } else {
+                    watch->match->dispatch(watch, events[I].events);
+                }
+            }
+            // удалять можно только после пачки: в ней могут быть события закончившихся игр
+            remove_finished();
+        }
+    }
+
+    void take_handoffs() {
+        uint64_t value;
+        if (read(wake_fd, &value, sizeof(value)) < 0) {
+            // разбудили одновременно с прошлым чтением
+        }
+        std::vector<Handoff> taken;
+        {
+            std::lock_guard<std::mutex> guard(handoffs_lock);
+            taken.swap(handoffs);
+        }
+        for (Handoff &handoff : taken) {
+            auto it = open_matches.find(handoff.match_id);
+            EpollMatch *match = it == open_matches.end()? NULL : it->second;
+            if (match == NULL || ! match->accepts_clients()) {
+                match = new EpollMatch(epoll_fd, handoff.result_path, client_cnt, handoff.config, handoff.match_id);
+                matches.push_back(match);
+                open_matches[handoff.match_id] = match;
+                if (! handoff.new_match) {
+                    match_count++;
+                }
+            } else if (handoff.new_match) {
+                // клиент дописан в уже идущий набор, учтённой игры не будет
+                match_count--;
+            }
+            match->add_client(handoff.fd, handoff.data);
+            if (! match->accepts_clients()) {
+                open_matches.erase(handoff.match_id);
+            }
+        }
+    }
+
+    void remove_finished() {
+        for (size_t I = 0; I < matches.size();) {
+            EpollMatch *match = matches[I];
+            if (! match->is_finished()) {
+                I++;
+                continue;
+            }
+            for (auto it = open_matches.begin(); it != open_matches.end(); ++it) {
+                if (it->second == match) {
+                    open_matches.erase(it);
+                    break;
+                }
+            }
+            delete match;
+            match_count--;
+            matches[I] = matches.back();
+            matches.pop_back();
+        }
+    }
+};
+
+
+class MatchServer
+{
+public:
+    // конфиг новой игры: случайные параметры и сид у каждой игры свои
+    typedef std::function<GameConfig()> ConfigGet;
+
+protected:
+    // подключение, от которого ещё не пришла строка с match_id
+    struct Pending {
+        int fd;
+        std::string data;
+        long long since;
+    };
+
+    // куда отдавать клиентов игры, которая ещё набирается
+    struct Route {
+        size_t worker;
+        int routed;
+        long long since;
+        GameConfig config;
+        std::string result_path;
+    };
+
+    std::string result_name;
+    int client_cnt;
+    ConfigGet get_config;
+
+    // у приёмного потока свой epoll: в data.fd - дескриптор
+    int epoll_fd;
+    int listen_fd;
+    std::vector<MatchWorker*> workers;
+    std::map<int, Pending*> pending;
+    std::map<std::string, Route> routes;
+
+public:
+    explicit MatchServer(const std::string &res_path, int _client_cnt, int threads_cnt, const ConfigGet &_get_config) :
+        result_name(res_path.substr(res_path.rfind('/') + 1)),
+        client_cnt(_client_cnt),
+        get_config(_get_config),
+        epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+        listen_fd(-1)
+    {
+        threads_cnt = std::max(1, threads_cnt);
+        for (int I = 0; I < threads_cnt; I++) {
+            workers.push_back(new MatchWorker(client_cnt));
+        }
+    }
+
+    virtual ~MatchServer() {
+        for (auto &item : pending) {
+            close(item.first);
+            delete item.second;
+        }
+        for (MatchWorker *worker : workers) {
+            delete worker;
+        }
+        if (listen_fd >= 0) close(listen_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+    }
+
+    void bind(const std::string &host, int port) {
+        std::cerr << "waiting for matches on " << host << ":" << port
+                  << " (" << workers.size() << " threads)" << std::endl;
+        listen_fd = epoll_listen(host, port);
+        if (listen_fd < 0) {
+            std::cerr << "Already bound to that port. listen() failed" << std::endl;
+            return;
+        }
+        watch(listen_fd);
+    }
+
+    int exec() {
+        if (listen_fd < 0) {
+            return 1;
+        }
+        const int MAX_EVENTS = 256;
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            // раз в секунду чистим зависшие подключения и недобранные игры
+            int count = epoll_wait(epoll_fd, events, MAX_EVENTS, 1000);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return 1;
+            }
+            for (int I = 0; I < count; I++) {
+                int fd = events[I].data.fd;
+                if (fd == listen_fd) {
+                    accept_clients();
+                    continue;
+                }
+                auto it = pending.find(fd);
+                if (it != pending.end()) {
+                    read_handshake(it->second);
+                }
+            }
+            expire();
+        }
+    }
+
+protected:
+    void watch(int fd) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void accept_clients() {
+        while (true) {
+            int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            pending[fd] = new Pending{fd, "", monotonic_us()};
+            watch(fd);
+        }
+    }
+
+    void drop_pending(Pending *client, const std::string &reason) {
+        if (! reason.empty()) {
+            std::cerr << "connection rejected: " << reason << std::endl;
+        }
+        pending.erase(client->fd);
+        close(client->fd);
+        delete client;
+    }
+
+    void read_handshake(Pending *client) {
+        char buffer[4096];
+        bool closed = false;
+        while (true) {
+            ssize_t size = recv(client->fd, buffer, sizeof(buffer), 0);
+            if (size > 0) {
+                client->data.append(buffer, size);
+                continue;
+            }
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            closed = size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+        size_t end = client->data.find('\n');
+        if (end == std::string::npos) {
+            if (closed) {
+                drop_pending(client, "");
+            } else if (client->data.size() >= size_t(MAX_RESP_LEN)) {
+                drop_pending(client, "handshake is too long");
+            }
+            return;
+        }
+
+        JsonValue json;
+        JsonReader reader(client->data.data(), end);
+        if (! reader.parse(json) || ! json.is_object()) {
+            drop_pending(client, "can't parse handshake");
+            return;
+        }
+        std::string match_id = json.value("match_id").to_string();
+        if (! valid_match_id(match_id)) {
+            drop_pending(client, "bad or missing 'match_id'");
+            return;
+        }
+
+        // сокет уходит в другой epoll, из приёмного его надо убрать до передачи
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+        route(match_id, client->fd, client->data);
+        pending.erase(client->fd);
+        delete client;
+    }
+
+    // id становится именем каталога
+    static bool valid_match_id(const std::string &match_id) {
+        if (match_id.empty() || match_id.size() > 64 || match_id[0] == '.') {
+            return false;
+        }
+        for (char c : match_id) {
+            if (! std::isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // игры кончаются в разное время, поэтому по кругу потоки загружались бы неровно
+    size_t least_loaded_worker() const {
+        size_t best = 0;
+        for (size_t I = 1; I < workers.size(); I++) {
+            if (workers[I]->get_match_count() < workers[best]->get_match_count()) {
+                best = I;
+            }
+        }
+        return best;
+    }
+
+    void route(const std::string &match_id, int fd, const std::string &data) {
+        MatchWorker::Handoff handoff;
+        handoff.match_id = match_id;
+        handoff.fd = fd;
+        handoff.data = data;
+        handoff.new_match = false;
+
+        auto it = routes.find(match_id);
+        if (it == routes.end()) {
+            // новая игра: свой конфиг и свой каталог логов
+            Route route = {least_loaded_worker(), 0, monotonic_us(), get_config(), ""};
+            route.config.LOG_DIR += match_id + "/";
+            mkdir(route.config.LOG_DIR.c_str(), 0755);
+            route.result_path = route.config.LOG_DIR + result_name;
+
+            handoff.new_match = true;
+            it = routes.insert(std::make_pair(match_id, route)).first;
+        }
+        handoff.config = it->second.config;
+        handoff.result_path = it->second.result_path;
+        size_t worker = it->second.worker;
+        if (++it->second.routed >= client_cnt) {
+            routes.erase(it);
+        }
+        workers[worker]->hand_off(std::move(handoff));
+    }
+
+    void expire() {
+        long long deadline = monotonic_us() - CONNECT_TIMEOUT * 1000000LL;
+        for (auto it = routes.begin(); it != routes.end();) {
+            if (it->second.since < deadline) {
+                // игра уже сама закончилась по CONNECT_TIMEOUT
+                it = routes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::vector<Pending*> stale;
+        for (auto &item : pending) {
+            if (item.second->since < deadline) {
+                stale.push_back(item.second);
+            }
+        }
+        for (Pending *client : stale) {
+            drop_pending(client, "no handshake");
+        }
+    }
+};
+
+#endif // MATCH_SERVER_H
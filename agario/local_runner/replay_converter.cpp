@@ -0,0 +1,61 @@
+#include "core/replay_format.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+
+// Преобразование визио-лога между текстовым и двоичным видом (replay_format.h).
+// Направление определяется по входному файлу.
+//
+//   replay_converter [-f] input output
+//
+// -f при переводе в двоичный вид хранит координаты во float; без него текст
+// из двоичного лога совпадает с исходным побайтно.
+
+static void usage() {
+    std::cerr << "usage: replay_converter [-f] input output" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    bool float32 = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "f")) != -1) {
+        switch (opt) {
+        case 'f': float32 = true; break;
+        default: usage(); return 1;
+        }
+    }
+    if (argc - optind != 2) {
+        usage();
+        return 1;
+    }
+
+    std::ifstream input(argv[optind], std::ios::in | std::ios::binary);
+    if (! input.is_open()) {
+        std::cerr << "cannot read " << argv[optind] << std::endl;
+        return 1;
+    }
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    std::string result;
+    if (BinaryLogReader::is_binary(data.data(), data.size())) {
+        if (! binary_log_to_text(data.data(), data.size(), result)) {
+            std::cerr << "broken binary log " << argv[optind] << std::endl;
+            return 1;
+        }
+    } else {
+        text_log_to_binary(data, result, float32);
+    }
+
+    std::ofstream output(argv[optind + 1], std::ios::out | std::ios::trunc | std::ios::binary);
+    if (! output.is_open()) {
+        std::cerr << "cannot write " << argv[optind + 1] << std::endl;
+        return 1;
+    }
+    output << result;
+    return 0;
+}
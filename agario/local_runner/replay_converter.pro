@@ -0,0 +1,10 @@
+TEMPLATE = app
+
+CONFIG += c++11 warn_off console thread
+CONFIG -= qt app_bundle
+
+TARGET = replay_converter
+
+include(core/core.pri)
+
+SOURCES += replay_converter.cpp
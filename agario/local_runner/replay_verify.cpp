@@ -0,0 +1,399 @@
+#include "core/mechanic.h"
+#include "core/replay_index.h"
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+
+// Проверка детерминизма механики по записанным визио-логам: игра из лога
+// пересчитывается без GUI и без задержек между тиками, каждая строка нового
+// лога сравнивается с записанной, выводится первый разошедшийся тик.
+//
+//   replay_verify [-j потоков] game.log.bin [game2.log.gz game3.log ...]
+//
+// Из лога берутся параметры игры, точки появления объектов и команды игроков;
+// всё остальное (движение, поедание, слияния, очки) считает механика. Строки
+// стратегий (D, S, E, OI) при пересчёте не появляются и пропускаются, у строки
+// OW не сравнивается сид: в логе лежит не исходный сид игры, а производное от
+// него число. Код выхода 0 - ни один лог не разошёлся.
+//
+// Двоичный лог (.bin, его пишут серверы и batch_runner -b) хранит числа точно,
+// и новый лог должен совпасть с ним строка в строку. В текстовом логе и его .gz
+// числа округлены до %.16g: повтор по округлённым командам уходит от записанного
+// на единицы последнего знака, и расхождение растёт с каждым тиком. Поэтому у
+// текста слова сравниваются точно, а нецелые числа - с относительной точностью
+// TEXT_TOLERANCE, в выводе - наибольшее отклонение. В длинной игре округление
+// может изменить и сам ход игры (фрагмент съест другой на тик позже). Если
+// текстовый лог разошёлся, когда отклонение уже дошло до PRECISION_DRIFT, это
+// не считается расхождением механики: печатается "unverifiable after tick T
+// (text precision)", и такая игра проверяется только по .bin. Расхождение при
+// меньшем отклонении - настоящее. Лог с координатами во float
+// (batch_runner -B) проверить нельзя.
+
+static const double TEXT_TOLERANCE = 1e-6;
+// Отклонение, с которого расхождение текстового лога списывается на округление.
+// Оно копится постепенно (к 5-10 тысячному тику доходит до TEXT_TOLERANCE),
+// а правка лога или механики сразу даёт скачок при почти нулевом отклонении.
+static const double PRECISION_DRIFT = TEXT_TOLERANCE * 1e-3;
+
+struct VerifyOptions {
+    int threads;
+    std::vector<std::string> logs;
+};
+
+static void usage() {
+    std::cerr << "usage: replay_verify [-j threads] game.log.bin [game2.log.gz game3.log ...]" << std::endl;
+}
+
+static bool parse_options(int argc, char *argv[], VerifyOptions &options) {
+    options.threads = int(std::thread::hardware_concurrency());
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1) {
+        switch (opt) {
+        case 'j': options.threads = std::atoi(optarg); break;
+        default: return false;
+        }
+    }
+    for (int I = optind; I < argc; I++) {
+        options.logs.push_back(argv[I]);
+    }
+    return ! options.logs.empty();
+}
+
+// строки, которые пишут стратегии и сервер, а не механика
+static bool is_strategy_line(const std::string &line) {
+    if (line.size() > 1 && (line[0] == 'D' || line[0] == 'S' || line[0] == 'E') && std::isdigit((unsigned char)line[1])) {
+        return true;
+    }
+    return line.compare(0, 2, "OI") == 0;
+}
+
+static std::string normalized(const std::string &line) {
+    if (line.compare(0, 3, "OW ") == 0) {
+        size_t seed = line.rfind(" S");
+        if (seed != std::string::npos) {
+            return line.substr(0, seed);
+        }
+    }
+    return line;
+}
+
+static bool is_number_start(const char *p) {
+    return std::isdigit((unsigned char)p[0]) || (p[0] == '-' && std::isdigit((unsigned char)p[1]));
+}
+
+static bool is_integral(const char *begin, const char *end) {
+    for (const char *p = begin; p < end; p++) {
+        if (*p == '.' || *p == 'e' || *p == 'E') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Строки текстового лога: слова совпадают, числа - с точностью до
+// TEXT_TOLERANCE (целые, в том числе id, - точно). В drift - наибольшее
+// отклонение среди совпавших чисел.
+static bool same_rounded(const std::string &expected, const std::string &actual, double &drift) {
+    const char *a = expected.c_str(), *b = actual.c_str();
+    while (*a != '\0' && *b != '\0') {
+        if (! is_number_start(a) || ! is_number_start(b)) {
+            if (*a++ != *b++) {
+                return false;
+            }
+            continue;
+        }
+        char *a_end, *b_end;
+        double x = std::strtod(a, &a_end), y = std::strtod(b, &b_end);
+        if (is_integral(a, a_end) && is_integral(b, b_end)) {
+            if (a_end - a != b_end - b || std::strncmp(a, b, a_end - a) != 0) {
+                return false;
+            }
+        } else {
+            double diff = std::fabs(x - y) / std::max(1.0, std::max(std::fabs(x), std::fabs(y)));
+            if (! (diff <= TEXT_TOLERANCE)) {
+                return false;
+            }
+            drift = std::max(drift, diff);
+        }
+        a = a_end;
+        b = b_end;
+    }
+    return *a == *b;
+}
+
+// команда игрока: C{id} или C{id}.{фрагмент}
+static bool is_command_line(const std::string &line) {
+    return line.size() > 1 && line[0] == 'C' && std::isdigit((unsigned char)line[1]);
+}
+
+// команды упорядочиваются по игроку и фрагменту
+static bool command_less(const std::string &a, const std::string &b) {
+    return a.compare(0, a.find(' '), b, 0, b.find(' ')) < 0;
+}
+
+// Построчное сравнение нового лога с записанным. Команды одного тика сервер
+// пишет в порядке прихода ответов, а повтор - по порядку игроков, поэтому
+// подряд идущие команды сравниваются без учёта порядка.
+class LogComparer
+{
+private:
+    ReplayCursor recorded;
+    bool exact;
+    int recorded_tick;
+    std::string expected;
+    bool peeked;                    // expected прочитана, но ещё не сравнена
+    std::string line;
+    std::vector<std::string> expected_commands;
+    std::vector<std::string> actual_commands;
+
+    bool next_recorded() {
+        if (peeked) {
+            peeked = false;
+            return true;
+        }
+        while (recorded.next_line(expected)) {
+            if (expected.size() > 1 && expected[0] == 'T' && std::isdigit((unsigned char)expected[1])) {
+                recorded_tick = std::atoi(expected.c_str() + 1);
+            }
+            if (! is_strategy_line(expected)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool next_line(const std::string &text, size_t &pos, std::string &result) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            return false;
+        }
+        result.assign(text, pos, end - pos);
+        pos = end + 1;
+        return true;
+    }
+
+    bool same(const std::string &recorded_line, const std::string &actual_line) {
+        return exact? normalized(recorded_line) == normalized(actual_line) :
+                      same_rounded(normalized(recorded_line), normalized(actual_line), drift);
+    }
+
+    void diverged(const std::string &recorded_line, const std::string &actual_line) {
+        error = "diverged at tick " + std::to_string(recorded_tick) +
+                "\n  expected: " + recorded_line + "\n  actual:   " + actual_line;
+    }
+
+    // команды из actual_commands против стольких же команд записанного лога
+    bool compare_commands() {
+        expected_commands.clear();
+        while (expected_commands.size() < actual_commands.size() && next_recorded()) {
+            if (! is_command_line(expected)) {
+                peeked = true;
+                break;
+            }
+            expected_commands.push_back(expected);
+        }
+        // в записанном логе команд больше
+        if (expected_commands.size() == actual_commands.size() && next_recorded()) {
+            peeked = true;
+            if (is_command_line(expected)) {
+                diverged(expected, "(no command)");
+                return false;
+            }
+        }
+        std::sort(expected_commands.begin(), expected_commands.end(), command_less);
+        std::sort(actual_commands.begin(), actual_commands.end(), command_less);
+        for (size_t I = 0; I < actual_commands.size(); I++) {
+            if (I >= expected_commands.size()) {
+                diverged(peeked? expected : "(recorded log ended)", actual_commands[I]);
+                return false;
+            }
+            if (! same(expected_commands[I], actual_commands[I])) {
+                diverged(expected_commands[I], actual_commands[I]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    std::string error;
+    double drift;
+
+    LogComparer(const std::string &path, bool _exact) :
+        recorded(path),
+        exact(_exact),
+        recorded_tick(0),
+        peeked(false),
+        drift(0)
+    {}
+
+    // сравнивает очередной кусок нового лога; false - нашлось расхождение
+    bool compare(const std::string &text) {
+        size_t pos = 0;
+        while (next_line(text, pos, line)) {
+            if (is_strategy_line(line)) {
+                continue;
+            }
+            if (is_command_line(line)) {
+                actual_commands.assign(1, line);
+                size_t next = pos;
+                while (next_line(text, next, line) && (is_command_line(line) || is_strategy_line(line))) {
+                    if (is_command_line(line)) {
+                        actual_commands.push_back(line);
+                    }
+                    pos = next;
+                }
+                if (! compare_commands()) {
+                    return false;
+                }
+                continue;
+            }
+            if (! next_recorded()) {
+                error = "diverged after tick " + std::to_string(recorded_tick) + ": recorded log ended\n  actual:   " + line;
+                return false;
+            }
+            if (! same(expected, line)) {
+                diverged(expected, line);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // тик записанного лога, на котором остановилось сравнение
+    int tick() const {
+        return recorded_tick;
+    }
+
+    // после конца игры в записанном логе ничего не должно остаться
+    bool finish(int tick) {
+        if (next_recorded()) {
+            error = "diverged at tick " + std::to_string(recorded_tick) + ": game ended at tick " +
+                    std::to_string(tick) + "\n  expected: " + expected;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Команды тика из лога. Как на сервере, команду получает только игрок, для
+// которого она записана: отключившийся клиент не стоит на месте, а не
+// управляет вовсе. Обзор пересчитывается до команд, пока кто-то играет -
+// раннер и сервер делают это, собирая состояние для стратегий.
+static void apply_commands(Mechanic &mechanic, const ReplayLog &replay_log) {
+    bool first = true;
+    for (auto &score : mechanic.get_scores()) {
+        Direct direct(0, 0);
+        if (! replay_log.find_command(mechanic.get_tick(), score.first, direct)) {
+            continue;
+        }
+        if (first) {
+            mechanic.update_visions();
+            first = false;
+        }
+        mechanic.apply_direct_for(score.first, direct);
+    }
+}
+
+// "path: ok N ticks", "path: unverifiable after tick T ..." или "path: diverged at tick T ..."
+static std::string verify(const std::string &path, int parse_threads) {
+    char head[REPLAY_HEADER_SIZE] = {0};
+    std::ifstream(path, std::ios::in | std::ios::binary).read(head, sizeof(head));
+    bool binary = BinaryLogReader::is_binary(head, sizeof(head));
+    if (binary && (head[5] & REPLAY_FLOAT32)) {
+        return path + ": cannot verify: coordinates are stored as float\n";
+    }
+    std::shared_ptr<ReplayLog> replay_log = std::make_shared<ReplayLog>(path, parse_threads, true);
+    if (replay_log->header().empty()) {
+        return path + ": cannot read replay\n";
+    }
+    GameConfig config = GameConfig::from_env([&replay_log] (const std::string &name, const std::string &value) {
+        auto param = replay_log->params().find(name);
+        if (param != replay_log->params().end()) {
+            return param->second;
+        }
+        auto header = replay_log->header().find(name);
+        return header != replay_log->header().end()? header->second : value;
+    });
+
+    Mechanic mechanic(config);
+    Logger *logger = mechanic.get_logger();
+    logger->set_capture(true);
+    mechanic.set_replay_log(replay_log, true);
+    mechanic.init_objects(config.SEED, [] (Player*) -> Strategy* {
+        return NULL;
+    });
+
+    LogComparer comparer(path, binary);
+    std::string text;
+    bool is_paused = false;
+    int tick = 0;
+    bool same = true;
+    while (same && tick < config.GAME_TICKS && ! mechanic.known()) {
+        apply_commands(mechanic, *replay_log);
+        tick = mechanic.tickEvent(is_paused);
+        text.clear();
+        logger->take_captured(text);
+        same = comparer.compare(text);
+    }
+    // GAME_TICKS взят из заголовка, куда раннеры пишут число сыгранных
+    // тиков, так что и заголовок нового лога совпадает с записанным
+    same = same && comparer.finish(tick);
+    char drift[32];
+    std::snprintf(drift, sizeof(drift), "%.2g", comparer.drift);
+    if (! same && ! binary && comparer.drift >= PRECISION_DRIFT) {
+        // повтор уже ушёл от округлённых чисел лога: дальше текст не проверить
+        return path + ": unverifiable after tick " + std::to_string(std::max(0, comparer.tick() - 1)) +
+                " (text precision), max drift " + drift + "\n";
+    }
+    if (! same) {
+        return path + ": " + comparer.error + "\n";
+    }
+    if (! binary) {
+        return path + ": ok " + std::to_string(tick) + " ticks, max drift " + drift + "\n";
+    }
+    return path + ": ok " + std::to_string(tick) + " ticks\n";
+}
+
+int main(int argc, char *argv[]) {
+    VerifyOptions options;
+    if (! parse_options(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    std::mutex out_lock;
+    int failed = 0;
+    // один лог разбирается на всех потоках, много логов - по логу на поток
+    int parse_threads = options.logs.size() == 1? options.threads : 1;
+    WorkStealingPool pool(options.threads);
+    for (const std::string &path : options.logs) {
+        pool.submit([&, path] {
+            std::string result = verify(path, parse_threads);
+
+            std::lock_guard<std::mutex> guard(out_lock);
+            std::cout << result << std::flush;
+            if (result.compare(path.size(), 5, ": ok ") != 0 &&
+                    result.compare(path.size(), 15, ": unverifiable ") != 0) {
+                failed++;
+            }
+        });
+    }
+    pool.wait();
+    return failed == 0? 0 : 1;
+}
@@ -0,0 +1,12 @@
+TEMPLATE = app
+
+CONFIG += c++11 warn_off console thread
+CONFIG -= qt app_bundle
+
+TARGET = replay_verify
+
+include(core/core.pri)
+
+SOURCES += replay_verify.cpp
+
+LIBS += -lpthread
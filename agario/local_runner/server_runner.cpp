@@ -1,4 +1,8 @@
+#ifdef EPOLL_SERVER
+#include "match_server.h"
+#else
 #include "tcp_server.h"
+#endif
 #include <iostream>
 
 #include <QCoreApplication>
@@ -6,7 +10,7 @@
 
 int main(int argc, char *argv[]) {
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    Constants::initialize(env);
+    GameConfig config = load_config(env);
 
     QString result_path = env.value("GAME_LOG_LOCATION");
     if (result_path == "") {
@@ -14,11 +18,29 @@ int main(int argc, char *argv[]) {
         return 0;
     }
     QString client_cnt = env.value("CLIENT_CNT", "4");
+
+#ifdef EPOLL_SERVER
+    // много игр в одном процессе (match_server.h)
+    int match_threads = env.value("MATCH_THREADS", "0").toInt();
+    if (match_threads > 0) {
+        MatchServer server(result_path.toStdString(), client_cnt.toInt(), match_threads, [&env] () {
+            return load_config(env);
+        });
+        server.bind(HOST.toStdString(), PORT);
+        return server.exec();
+    }
+
+    // без QCoreApplication: цикл событий свой (epoll_server.h)
+    EpollServer server(result_path.toStdString(), client_cnt.toInt(), config);
+    server.bind(HOST.toStdString(), PORT);
+    return server.exec();
+#else
     QCoreApplication a(argc, argv);
 
-    TcpServer server(result_path, client_cnt.toInt());
+    TcpServer server(result_path, client_cnt.toInt(), config);
     server.bind(HOST, PORT);
 
     QObject::connect(&server, SIGNAL(game_finished()), &a, SLOT(quit()));
     return a.exec();
+#endif
 }
@@ -10,22 +10,19 @@ CONFIG -= app_bundle
 
 TEMPLATE = app
 
-HEADERS  += mechanic.h \
-    logger.h \
-    entities/food.h \
-    entities/circle.h \
-    constants.h \
-    strategies/strategy.h \
-    strategies/bymouse.h \
-    entities/virus.h \
-    entities/player.h \
-    entities/ejection.h \
+include(core/core.pri)
+
+HEADERS  += constants.h \
+    adapters/json.h \
     tcp_server.h \
-    tcp_connect.h
+    tcp_connect.h \
+    epoll_server.h \
+    match_server.h
+
+# сервер на epoll и timerfd вместо цикла событий Qt (только Linux)
+epoll_server: DEFINES += EPOLL_SERVER
 
 SOURCES += server_runner.cpp
 
 DISTFILES += \
     ../Dockerfile
-
-LIBS += -lz
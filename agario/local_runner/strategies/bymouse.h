@@ -1,7 +1,7 @@
 #ifndef BYMOUSE_H
 #define BYMOUSE_H
 
-#include "strategy.h"
+#include "../core/strategy.h"
 
 #include <QMouseEvent>
 #include <QKeyEvent>
@@ -15,11 +15,10 @@ protected:
     bool split;
 
 public:
-    explicit ByMouse(int _id) :
+    explicit ByMouse(int _id, const GameConfig &config) :
         Strategy(_id)
     {
-        Constants &ins = Constants::instance();
-        x = ins.GAME_WIDTH / 2; y = ins.GAME_HEIGHT / 2;
+        x = config.GAME_WIDTH / 2; y = config.GAME_HEIGHT / 2;
     }
 
     virtual ~ByMouse() {}
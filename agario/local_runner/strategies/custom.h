@@ -1,20 +1,26 @@
 #ifndef CUSTOM_H
 #define CUSTOM_H
 
-#include "strategy.h"
+#include "../core/strategy.h"
+#include "../core/json_writer.h"
+#include "../adapters/json.h"
+#include <QObject>
+#include <QDebug>
 #include <QProcess>
 #include <QJsonArray>
 #include <QJsonDocument>
 
 
-class Custom : public Strategy
+class Custom : public QObject, public Strategy
 {
     Q_OBJECT
 
 protected:
+    const GameConfig config;
     QProcess *solution;
     bool is_running;
     QMetaObject::Connection finish_connection;
+    std::string state_message;
 
     QDebug debug() {
         return qDebug().noquote();
@@ -24,8 +30,9 @@ signals:
     void error(QString);
 
 public:
-    explicit Custom(int _id, const QString &_path) :
+    explicit Custom(int _id, const QString &_path, const GameConfig &_config) :
         Strategy(_id),
+        config(_config),
         solution(new QProcess(this))
     {
         solution->start(_path);
@@ -36,7 +43,6 @@ public:
     }
 
     virtual ~Custom() {
-        Constants &ins = Constants::instance();
         if (solution) {
             disconnect(finish_connection);
             //PlayerArray pa;
@@ -44,7 +50,7 @@ public:
             //QString message = prepare_state(pa, ca);
             //int sent = solution->write(message.toStdString().c_str());
             //solution->waitForBytesWritten(500);
-            //bool success = solution->waitForReadyRead(ins.RESP_TIMEOUT * 1000);
+            //bool success = solution->waitForReadyRead(config.RESP_TIMEOUT * 1000);
             //if (!success) {
             //    solution->waitForFinished(500);
             //}
@@ -57,18 +63,17 @@ public:
         if (! is_running) {
             return Direct(0, 0);
         }
-        QString message = prepare_state(fragments, objects);
-        debug() << message;
-        message += "\n";
-        int sent = solution->write(message.toStdString().c_str());
+        // сообщение пишется сразу в UTF-8, без QJsonDocument и QString
+        JsonWriter::write_state(state_message, fragments, objects);
+        debug() << QByteArray::fromRawData(state_message.data(), int(state_message.size()) - 1);
+        int sent = solution->write(state_message.data(), state_message.size());
         if (sent == -1) {
             emit error("Can't write to process");
             return Direct(0, 0);
         }
-        Constants &ins = Constants::instance();
         QByteArray cmdBytes = "";
         while (! cmdBytes.endsWith('\n')) {
-            bool success = solution->waitForReadyRead(ins.RESP_TIMEOUT * 1000);
+            bool success = solution->waitForReadyRead(config.RESP_TIMEOUT * 1000);
             if (! success) {
                 cmdBytes.append(solution->readAllStandardOutput());
                 cmdBytes.append(solution->readAllStandardError());
@@ -104,12 +109,15 @@ public:
             if (player->getId() == id) {
                 my_player = player;
                 my_player->debug_message.clear();
-                my_player->debug_draw = QJsonObject();
+                my_player->debug_draw.clear();
             }
         }
         if (my_player != nullptr) {
-            my_player->debug_message = json.value("Debug").toString();
-            my_player->debug_draw = json.value("Draw").toObject();
+            my_player->debug_message = json.value("Debug").toString().toStdString();
+            QJsonObject draw = json.value("Draw").toObject();
+            if (!draw.isEmpty()) {
+                my_player->debug_draw = QJsonDocument(draw).toJson(QJsonDocument::Compact).toStdString();
+            }
         }
 
         if (json.value("Pause").toBool(false)) {
@@ -133,7 +141,7 @@ public slots:
 
 public:
     void send_config() {
-        QJsonDocument jsonDoc(Constants::instance().toJson());
+        QJsonDocument jsonDoc(to_json(config));
         QString message = QString(jsonDoc.toJson(QJsonDocument::Compact));
         debug() << message;
         message += "\n";
@@ -143,23 +151,6 @@ public:
         }
     }
 
-    QString prepare_state(const PlayerArray &fragments, const CircleArray &visibles) {
-        QJsonArray mineArray;
-        for (Player *player : fragments) {
-            mineArray.append(player->toJson(true));
-        }
-        QJsonArray objectsArray;
-        for (Circle *circle : visibles) {
-            objectsArray.append(circle->toJson());
-        }
-        QJsonObject json;
-        json.insert("Mine", mineArray);
-        json.insert("Objects", objectsArray);
-
-        QJsonDocument jsonDoc(json);
-        return QString(jsonDoc.toJson(QJsonDocument::Compact));
-    }
-
     QJsonObject parse_answer(QByteArray &data) {
         QJsonObject empty;
         if (data.length() < 3) {
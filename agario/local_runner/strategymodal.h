@@ -1,7 +1,8 @@
 #ifndef STRATEGYMODAL_H
 #define STRATEGYMODAL_H
 
-#include "strategies/strategy.h"
+#include "constants.h"
+#include "core/strategy.h"
 #include "strategies/bymouse.h"
 #include "strategies/custom.h"
 
@@ -117,7 +118,7 @@ public:
         return Qt::black;
     }
 
-    Strategy* get_strategy(int playerId) const {
+    Strategy* get_strategy(int playerId, const GameConfig &config) const {
         const auto& cur_gui = gui_of_player[playerId % 4];
         if (cur_gui.rbn_comp->isChecked()) {
             QString comp = cur_gui.choose_comp->currentText();
@@ -125,11 +126,11 @@ public:
             return NULL;
         }
         else if (cur_gui.rbn_mouse->isChecked()) {
-            return new ByMouse(playerId);
+            return new ByMouse(playerId, config);
         }
         else if (cur_gui.rbn_custom->isChecked()) {
             QString prog_path = cur_gui.edit_custom->text();
-            return new Custom(playerId, prog_path);
+            return new Custom(playerId, prog_path, config);
         }
         return NULL;
     }
@@ -1,7 +1,11 @@
 #ifndef TCP_CONNECT_H
 #define TCP_CONNECT_H
 
-#include "logger.h"
+#include "constants.h"
+#include "core/logger.h"
+#include "core/json_writer.h"
+#include "core/wire_format.h"
+#include "adapters/json.h"
 #include <QTimerEvent>
 #include <QDateTime>
 #include <QJsonDocument>
@@ -16,6 +20,7 @@ class ClientWrapper : public QObject
     Q_OBJECT
 
 protected:
+    const GameConfig config;
     QTcpSocket *socket;
     Logger *logger;
     Logger *dump_logger;
@@ -26,6 +31,10 @@ protected:
     bool is_active;
 
     QByteArray got_data;
+    SharedBufferSlot state_message;
+    SharedBufferSlot wire_message;
+    StateProtocol protocol;
+    JsonDeltaState delta;
 
     // timeouts implementation
     int timerId;
@@ -42,17 +51,22 @@ signals:
     void sprite(QString, QString);
 
 public:
-    explicit ClientWrapper(QTcpSocket *_socket) :
+    explicit ClientWrapper(QTcpSocket *_socket, const GameConfig &_config) :
+        config(_config),
         socket(_socket),
-        logger(new Logger),
-        dump_logger(new Logger),
+        logger(new Logger(config)),
+        dump_logger(new Logger(config)),
         is_ready(false),
         wait_timeout(0),
         waiting(false),
         sum_waiting(0),
         is_active(false),
-        answered(false)
+        answered(false),
+        protocol(PROTOCOL_JSON),
+        delta(config.BASE_TICK)
     {
+        // дамп состояний пишется каждый тик: пусть пишет отдельный поток
+        dump_logger->set_async(true);
         timerId = startTimer(100);
         connect(socket, SIGNAL(readyRead()), this, SLOT(read_data()));
         connect(socket, SIGNAL(disconnected()), this, SLOT(client_disconnected()));
@@ -60,6 +74,7 @@ public:
 
     virtual ~ClientWrapper() {
         if (logger) delete logger;
+        if (dump_logger) delete dump_logger;
         if (socket) delete socket;
     }
 
@@ -85,7 +100,7 @@ public:
 
         if (event->timerId() == timerId && waiting && is_active) {
             wait_timeout++;
-            if (wait_timeout > Constants::instance().RESP_TIMEOUT * 10) {
+            if (wait_timeout > config.RESP_TIMEOUT * 10) {
                 bool is_expired = accumulate_wait();
                 if (is_expired) return;
 
@@ -101,7 +116,7 @@ public:
         sum_waiting += wait_timeout;
         wait_timeout = 0;
 
-        if (sum_waiting > Constants::instance().SUM_RESP_TIMEOUT * 10) {
+        if (sum_waiting > config.SUM_RESP_TIMEOUT * 10) {
             is_active = false;
             emit error(SUM_RESP_EXPIRED);
             this->socket->disconnectFromHost();
@@ -132,6 +147,10 @@ public slots:
     }
 
     void read_data() {
+        if (is_ready && protocol == PROTOCOL_BINARY) {
+            read_frames();
+            return;
+        }
         QByteArray data = socket->readLine(MAX_RESP_LEN + 1);
         if (data[data.length() - 1] != '\n' && data.length() < MAX_RESP_LEN) {
             got_data.append(data);
@@ -157,9 +176,21 @@ public slots:
                 return;
             }
 
+            if (keys.contains("protocol")) {
+                QString name = json.value("protocol").toString();
+                if (name == "delta") {
+                    protocol = PROTOCOL_DELTA;
+                } else if (name == "binary") {
+                    protocol = PROTOCOL_BINARY;
+                } else if (name != "json") {
+                    emit error("Unknown protocol '" + name + "'");
+                    return;
+                }
+            }
+
             solution_id = json.value("solution_id").toString();
-            logger->init_file(solution_id, DEBUG_FILE);
-            dump_logger->init_file(solution_id, DUMP_FILE);
+            logger->init_file(solution_id.toStdString(), DEBUG_FILE);
+            dump_logger->init_file(solution_id.toStdString(), DUMP_FILE);
             is_ready = true;
             emit ready();
         }
@@ -171,7 +202,7 @@ public slots:
             }
             got_data.clear();
             QJsonDocument doc(json);
-            dump_logger->write_raw_with_old_tick(doc.toJson(QJsonDocument::Compact)+ "\n");
+            dump_logger->write_raw_with_old_tick((doc.toJson(QJsonDocument::Compact) + "\n").toStdString());
             QStringList keys = json.keys();
             if (keys.contains("error")) {
                 QString err_msg = json.value("error").toString();
@@ -194,26 +225,71 @@ public slots:
             if (keys.contains("Eject")) {
                 result.eject = json.value("Eject").toBool(false);
             }
-            if (keys.contains("Debug")) {
-                QString msg = json.value("Debug").toString("");
-                if (msg != "") {
-                    msg = msg.left(MAX_DEBUG_LEN);
-                    emit debug(msg);
-                }
-            }
+            QString player, sprite_msg;
             if (keys.contains("Sprite")) {
                 QJsonObject spriteJson = json.value("Sprite").toObject();
-                if (! spriteJson.empty()) {
-                    QString player = spriteJson.value("Id").toString("");
-                    QString msg = spriteJson.value("S").toString("");
-                    if (player != "" && msg != "") {
-                        player = player.left(MAX_ID_LEN);
-                        msg = msg.left(MAX_DEBUG_LEN);
-                        emit sprite(player, msg);
-                    }
-                }
+                player = spriteJson.value("Id").toString("");
+                sprite_msg = spriteJson.value("S").toString("");
             }
-            emit response(result);
+            emit_answer(result, json.value("Debug").toString(""), player, sprite_msg);
+        }
+    }
+
+    void emit_answer(const Direct &result, QString msg, QString player, QString sprite_msg) {
+        if (msg != "") {
+            msg = msg.left(MAX_DEBUG_LEN);
+            emit debug(msg);
+        }
+        if (player != "" && sprite_msg != "") {
+            player = player.left(MAX_ID_LEN);
+            sprite_msg = sprite_msg.left(MAX_DEBUG_LEN);
+            emit sprite(player, sprite_msg);
+        }
+        emit response(result);
+    }
+
+    // Двоичный протокол (core/wire_format.h): кадры команд. Как и в JSON,
+    // на тик принимается один ответ, следующие до нового состояния
+    // отбрасываются.
+    void read_frames() {
+        got_data.append(socket->readAll());
+        uint32_t size;
+        while (WireReader::frame_size(got_data.constData(), got_data.size(), size)) {
+            if (size > uint32_t(MAX_RESP_LEN)) {
+                // границу следующего кадра уже не найти
+                got_data.clear();
+                emit error("Incorrect response (frame is too long)");
+                is_active = false;
+                socket->disconnectFromHost();
+                return;
+            }
+            if (uint32_t(got_data.size()) < WIRE_LENGTH_SIZE + size) {
+                return;
+            }
+            WireCommand command;
+            bool parsed = WireReader(got_data.constData() + WIRE_LENGTH_SIZE, size).read_command(command);
+            got_data.remove(0, WIRE_LENGTH_SIZE + size);
+            if (answered) {
+                continue;
+            }
+            answered = true;
+            if (accumulate_wait()) {
+                return;
+            }
+            if (! parsed) {
+                emit error("Incorrect response (broken frame)");
+                continue;
+            }
+            dump_logger->write_raw_with_old_tick(command.to_json());
+            if (command.kind == WIRE_ERROR) {
+                emit error(QString::fromStdString(command.debug).left(MAX_DEBUG_LEN));
+                continue;
+            }
+            Direct result(command.x, command.y);
+            result.split = (command.flags & WIRE_SPLIT) != 0;
+            result.eject = (command.flags & WIRE_EJECT) != 0;
+            emit_answer(result, QString::fromStdString(command.debug),
+                        QString::fromStdString(command.sprite_id), QString::fromStdString(command.sprite));
         }
     }
 
@@ -237,48 +313,57 @@ public slots:
     }
 
     void send_config() {
-        QJsonDocument jsonDoc(Constants::instance().toJson());
+        QJsonDocument jsonDoc(to_json(config));
         QString message = QString(jsonDoc.toJson(QJsonDocument::Compact)) + "\n";
 
-        int sent = socket->write(message.toStdString().c_str());
+        int sent;
+        if (protocol == PROTOCOL_BINARY) {
+            std::string &frame = wire_message.acquire();
+            WireWriter::write_config(frame, config);
+            sent = socket->write(frame.data(), frame.size());
+        } else {
+            sent = socket->write(message.toStdString().c_str());
+        }
         if (sent == 0) {
             emit error("Fatal error: can't send config");
         }
-        dump_logger->write_raw(0, message);
+        dump_logger->write_raw(0, message.toStdString());
         socket->flush();
     }
 
-    void send_state(const PlayerArray &fragments, const CircleArray &visibles, int tick=0) {
+    // объекты берутся из общего для всех клиентов кеша тика (см. broadcast_state)
+    void send_state(const PlayerArray &fragments, const CircleArray &visibles, int tick, JsonObjectCache &cache) {
         waiting = true;
         wait_timeout = 0;
 
-        QString message = prepare_state(fragments, visibles);
-        int sent = socket->write(message.toStdString().c_str());
+        int sent;
+        if (protocol == PROTOCOL_DELTA) {
+            std::string &message = state_message.acquire();
+            delta.write_state(message, fragments, visibles, cache);
+            sent = socket->write(message.data(), message.size());
+        } else if (protocol == PROTOCOL_BINARY) {
+            std::string &frame = wire_message.acquire();
+            WireWriter::write_state(frame, tick, fragments, visibles);
+            sent = socket->write(frame.data(), frame.size());
+        } else {
+            std::string &message = state_message.acquire();
+            cache.write_state(message, fragments, visibles);
+            sent = socket->write(message.data(), message.size());
+        }
         if (sent == 0) {
             emit error("Fatal error: can't send state");
         }
-        dump_logger->write_raw(tick + 1, message);
+        // дамп держит ссылку на то же сообщение, а не копию; JSON для дампа
+        // двоичного клиента собирает из кадра поток логгера
+        if (protocol == PROTOCOL_BINARY) {
+            dump_logger->write_wire_state(tick + 1, wire_message.get());
+        } else {
+            dump_logger->write_raw(tick + 1, state_message.get());
+        }
         socket->flush();
         answered = false;
     }
 
-    QString prepare_state(const PlayerArray &fragments, const CircleArray &visibles) {
-        QJsonArray mineArray;
-        for (Player *player : fragments) {
-            mineArray.append(player->toJson(true));
-        }
-        QJsonArray objectsArray;
-        for (Circle *circle : visibles) {
-            objectsArray.append(circle->toJson());
-        }
-        QJsonObject json;
-        json.insert("Mine", mineArray);
-        json.insert("Objects", objectsArray);
-
-        QJsonDocument jsonDoc(json);
-        return QString(jsonDoc.toJson(QJsonDocument::Compact)) + "\n";
-    }
-
     Logger *get_logger() const {
         return logger;
     }
@@ -1,7 +1,7 @@
 #ifndef TCP_SERVER_H
 #define TCP_SERVER_H
 
-#include "mechanic.h"
+#include "core/mechanic.h"
 #include "tcp_connect.h"
 #include <unistd.h>
 #include <QTcpServer>
@@ -14,11 +14,14 @@ class TcpServer : public QObject
     Q_OBJECT
 
 protected:
+    const GameConfig config;
     QString result_path;
 
     QTcpServer *server;
     Mechanic *mechanic;
     ClientWrappers clients;
+    // JSON объектов текущего тика, общий для сообщений всех клиентов
+    JsonObjectCache state_cache;
 
     int ready_cnt;
     int ready_player_id;
@@ -34,16 +37,22 @@ signals:
     void game_finished();
 
 public:
-    explicit TcpServer(const QString &_res_path, int _client_cnt) :
+    explicit TcpServer(const QString &_res_path, int _client_cnt, const GameConfig &_config) :
+        config(_config),
         result_path(_res_path),
         server(new QTcpServer),
-        mechanic(new Mechanic),
+        mechanic(new Mechanic(config)),
         ready_cnt(0),
         ready_player_id(1),
         client_cnt(_client_cnt),
         current_tick(0),
         game_active(false)
     {
+        // лог игры пишет отдельный поток, чтобы тик не ждал диска и zlib
+        mechanic->get_logger()->set_async(true);
+        mechanic->get_logger()->set_index(true);
+        // точный лог для replay_verify: в текстовом числа округлены
+        mechanic->get_logger()->set_binary(config.BINARY_LOG != 0);
         timerId = startTimer(1000);
         connect(server, SIGNAL(newConnection()), this, SLOT(client_connected()));
     }
@@ -84,7 +93,7 @@ public slots:
             return;
         }
         QTcpSocket *client_socket = server->nextPendingConnection();
-        ClientWrapper *client = new ClientWrapper(client_socket);
+        ClientWrapper *client = new ClientWrapper(client_socket, config);
         clients.append(client);
         //qDebug() << "client connected";
 
@@ -148,16 +157,16 @@ public slots:
         game_active = true;
         wait_timeout = 0;
 
-        auto seed = Constants::instance().SEED;
-        qDebug().noquote() << "starting game" << seed;
-        mechanic->init_objects(seed.toStdString(), [] (Player*) -> Strategy* {
+        std::string seed = config.SEED;
+        qDebug().noquote() << "starting game" << QString::fromStdString(seed);
+        mechanic->init_objects(seed, [] (Player*) -> Strategy* {
             return NULL;
         });
 
         Logger *ml = mechanic->get_logger();
         for (ClientWrapper *client : clients) {
             // independent from is_canceled
-            ml->write_solution_id(client->getId(), client->get_solution_id());
+            ml->write_solution_id(client->getId(), client->get_solution_id().toStdString());
         }
         broadcast_config();
 
@@ -175,11 +184,12 @@ public slots:
     }
 
     void broadcast_state() {
+        state_cache.clear();
         for (ClientWrapper *client : clients) {
             if (client->get_is_active()) {
                 PlayerArray fragments = mechanic->get_players_by_id(client->getId());
                 CircleArray visibles = mechanic->get_visibles(fragments);
-                client->send_state(fragments, visibles, current_tick);
+                client->send_state(fragments, visibles, current_tick, state_cache);
             }
         }
         ready_cnt = 0;
@@ -203,7 +213,7 @@ public slots:
             std::cerr << "tick " << tick << "\r";
         }
         current_tick = tick;
-        if (tick < Constants::instance().GAME_TICKS && !mechanic->known()) {
+        if (tick < config.GAME_TICKS && !mechanic->known()) {
             broadcast_state();
         }
         else {
@@ -217,7 +227,7 @@ public slots:
 //        qDebug() << "error (client=" << client->getId() << "):" << msg << "tick=" << current_tick;
 
         Logger *logger = client->get_logger();
-        logger->write_error(current_tick, client->getId(), msg);
+        logger->write_error(current_tick, client->getId(), msg.toStdString());
 
         if (get_answered_clients_count() == get_active_count() && game_active) {
             next_tick();
@@ -243,13 +253,13 @@ public slots:
     void client_debug(QString msg) {
         ClientWrapper *client = static_cast<ClientWrapper*>(sender());
         Logger *logger = client->get_logger();
-        logger->write_debug(current_tick, client->getId(), msg);
+        logger->write_debug(current_tick, client->getId(), msg.toStdString());
     }
 
     void client_sprite(QString playerId, QString msg) {
         ClientWrapper *client = static_cast<ClientWrapper*>(sender());
         Logger *logger = client->get_logger();
-        logger->write_to_sprite(current_tick, client->getId(), playerId, msg);
+        logger->write_to_sprite(current_tick, client->getId(), playerId.toStdString(), msg.toStdString());
     }
 
     void write_scores() {
@@ -261,7 +271,7 @@ public slots:
         QJsonDocument jsonDoc(jsonResult);
         QString result = QString(jsonDoc.toJson(QJsonDocument::Compact));
 
-        QFile file(Constants::instance().LOG_DIR + SCORES_FILE);
+        QFile file(QString::fromStdString(config.LOG_DIR) + SCORES_FILE);
         if (file.open(QIODevice::WriteOnly|QFile::Truncate)) {
             QTextStream f_Stream(&file);
             f_Stream << result;
@@ -272,31 +282,31 @@ public slots:
     void write_result() {
         QJsonObject jsonScores;
         jsonScores.insert("filename", QJsonValue(SCORES_FILE));
-        jsonScores.insert("location", QJsonValue(Constants::instance().LOG_DIR + SCORES_FILE));
+        jsonScores.insert("location", QJsonValue(QString::fromStdString(config.LOG_DIR) + SCORES_FILE));
         jsonScores.insert("is_private", QJsonValue(false));
 
         QJsonArray jsonDebugAll;
         for (ClientWrapper *client : clients) {
             Logger *cl = client->get_logger();
             QJsonObject jsonDebug;
-            jsonDebug.insert("filename", QJsonValue(cl->get_file_name() + ".gz"));
+            jsonDebug.insert("filename", QJsonValue(QString::fromStdString(cl->get_file_name() + ".gz")));
             jsonDebug.insert("is_private", QJsonValue(true));
-            jsonDebug.insert("location", QJsonValue(cl->get_path() + ".gz"));
+            jsonDebug.insert("location", QJsonValue(QString::fromStdString(cl->get_path() + ".gz")));
             jsonDebugAll.append(jsonDebug);
 
             cl = client->get_dump_logger();
             QJsonObject jsonDumpDebug;
-            jsonDebug.insert("filename", QJsonValue(cl->get_file_name() + ".gz"));
+            jsonDebug.insert("filename", QJsonValue(QString::fromStdString(cl->get_file_name() + ".gz")));
             jsonDebug.insert("is_private", QJsonValue(true));
-            jsonDebug.insert("location", QJsonValue(cl->get_path() + ".gz"));
+            jsonDebug.insert("location", QJsonValue(QString::fromStdString(cl->get_path() + ".gz")));
             jsonDebugAll.append(jsonDebug);
 
         }
         Logger *ml = mechanic->get_logger();
         QJsonObject jsonResult;
-        jsonResult.insert("filename", QJsonValue(ml->get_file_name() + ".gz"));
+        jsonResult.insert("filename", QJsonValue(QString::fromStdString(ml->get_file_name() + ".gz")));
         jsonResult.insert("is_private", QJsonValue(false));
-        jsonResult.insert("location", QJsonValue(ml->get_path() + ".gz"));
+        jsonResult.insert("location", QJsonValue(QString::fromStdString(ml->get_path() + ".gz")));
 
         QJsonObject jsonAll;
         jsonAll.insert(SCORES_JSON_KEY, QJsonValue(jsonScores));